@@ -1,7 +1,12 @@
 #include "cpu.h"
+#include "serve.h"
 
 // start with the parallel
 int main(int argc, char** argv) {
+    if (serveRequested(argc, argv)) { // answer the processes of stdin as they come
+        return serveRun(argc, argv, stdin, stdout) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     void * cpu = cpuInit(argc, argv); // create the cpu
 
     if (!cpu) { // invalid argument input.
@@ -9,18 +14,23 @@ int main(int argc, char** argv) {
     }
 
     // run the simulation
-    unsigned int time = 0;
+    unsigned long long time = cpuStartTime(cpu); // 0 unless resumed from a snapshot
 
     while (cpuRun(cpu, time)) {
-        
-        time++; // increment time to execute the next frame
+        cpuCheckpoint(cpu, time); // save the state if a snapshot is due
+
+        if (time == ~0ULL) {
+            break; // the last frame the clock can count
+        }
+        time = cpuNextTick(cpu, time); // the next frame, past the frames with nothing to do
     }
 
     // show stats
     cpuStats(cpu, time);
+    int failed = cpuFailed(cpu); // a pipelined run found an invalid process in the trace
 
     // release memory
     cpuDelete(cpu);
 
-    return EXIT_SUCCESS;
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
 }
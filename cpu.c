@@ -1,6 +1,32 @@
 #include "cpu.h"
+#include "snapshot.h"
+#include "select.h"
+#include "radix.h"
+#include "mlfq.h"
+#include "gang.h"
+#include "mempool.h"
+#include "fair.h"
+#include "sink.h"
+#include "trace.h"
+#include "stream.h"
+#include "ring.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+
+#define CPU_TRACE_RING 4096 // processes a pipelined run parses ahead of the simulation
+#define CPU_MESSAGE 256 // longest error message handed to an embedding program
 
 // Struct definitions
+
+// Process waiting for memory
+typedef struct {
+    void * hProc;
+    unsigned long long since; // time the process was ready to be placed
+} ADMISSION;
+
 typedef struct {
     unsigned int processors;
     char * processListFile;
@@ -9,13 +35,299 @@ typedef struct {
     void * hProcessors; // list of processors
     unsigned int unfinished; // number of pending processes 
     unsigned int finished;
+    unsigned long long startTime; // first tick to simulate
+    unsigned long long emitted; // bytes of events written so far
+    char * snapshotFile; // file the snapshots are appended to
+    char * resumeFile; // snapshot file to resume from
+    char * prefixFile; // output of the recorded run whose prefix is reused when resuming
+    long long divergeAt; // first tick whose decisions may differ from the recorded run, -1 if unused
+    long long checkpointAt; // tick to write a snapshot at, -1 if unused
+    unsigned int checkpointPeriod; // ticks between periodic snapshots, 0 if unused
+    size_t (*schedule)(void * hCPU, unsigned long long time); // scheduler selected at startup
+    unsigned int arrivalOrdered; // processes of the trace are sorted by arrival time
+    size_t nextArrival; // index of the first process that has not arrived yet (arrival ordered traces)
+    void ** hArrivals; // scratch array of the arriving processes
+    unsigned long long * arrivalKeys; // packed (exec, pid) key of each arriving process
+    void ** hArrivalScratch; // scratch space of the arrival sort
+    unsigned long long * arrivalKeyScratch;
+    size_t arrivalsSize; // capacity of the arrival arrays
+    unsigned long long * loads; // ranking key of each processor
+    unsigned long long * loadTies; // second ranking key of each processor (the remaining time, with -c)
+    unsigned long long * loadScratch; // scratch space of the selection kernel
+    unsigned int * ranked; // ids of the processors selected for an arriving process
+    unsigned int mlfqQuanta[MLFQ_MAX_LEVELS]; // time quantum of each feedback queue level (-m)
+    unsigned int mlfqLevels; // number of levels, 0 unless the feedback queues are used
+    unsigned int mlfqBoost; // period of the priority boost (-b)
+    void * hMlfq; // feedback queues of the processors
+    unsigned int switchCost; // ticks lost on each context switch (-x)
+    unsigned int coldWindow; // one tick of cold cache penalty per window ticks descheduled (-y)
+    unsigned int coldMax; // maximum cold cache penalty (-y window,max)
+    int gangPolicy; // policy of the gang scheduling (-g), -1 when parallel sub processes are queued independently
+    void * hGang; // gangs waiting to launch
+    unsigned int unevenSplit; // size the sub processes by the load of their cpus (-u)
+    double splitGain; // predicted turnaround saved by the uneven splits
+    unsigned int splitProcs; // number of parallel processes split unevenly
+    unsigned int hasDependencies; // the trace has after= columns
+    unsigned int criticalPath; // place the processes critical path first (-d)
+    unsigned long long criticalBound; // critical path lower bound of the makespan
+    unsigned long long totalWork; // least work of the processes loaded (see procWork)
+    unsigned long long longestBound; // latest finish of a process run alone from its arrival, evenly split
+    unsigned int reportBound; // print the makespan lower bound and the gap to it (-L)
+    void * hReleased; // processes released after their arrival by their last predecessor
+    unsigned int hasPhases; // the trace has phases= columns
+    void * hWoken; // sub processes whose I/O burst completed on this tick
+    unsigned long long memoryCapacity; // memory of each cpu or node (-M), 0 if unlimited
+    unsigned int memoryGroup; // cpus sharing a memory capacity (-M capacity:cpus)
+    void * hMemory; // free memory of the nodes
+    ADMISSION * admission; // processes waiting for memory, in the order they were ready
+    size_t admissionHead; // position of the first waiting process
+    size_t admissionCount;
+    size_t admissionSize; // capacity of the admission queue
+    unsigned int memoryFreed; // memory was released since the first waiting process was tried
+    unsigned long long admissionDelay; // ticks the processes waited for memory
+    unsigned int admissionDelayed; // number of processes that waited for memory
+    char ** tenantNames; // name of each tenant (tenant= column)
+    unsigned int * tenantWeights; // weight of each tenant (weight= column)
+    unsigned int tenants;
+    unsigned int tenantSize; // capacity of the tenant arrays
+    unsigned int hasTenants; // the trace has tenant= columns
+    unsigned int fairShare; // share the cpus between the tenants by weight (-w)
+    void * hFair; // fair share state of the cpus
+    unsigned int * tenantActive; // processes of each tenant that arrived and did not finish
+    unsigned int activeTenants; // tenants with an active process
+    unsigned long long * tenantContended; // cpu ticks of each tenant while several tenants were active
+    unsigned long long contended; // cpu ticks while several tenants were active
+    SINKFORMAT outputFormat; // format of the events (-o)
+    void * hSink; // writer of the events
+    char * eventFile; // binary event log (-o binary:<file>)
+    FILE * hEventFile;
+    void ** hSegments; // sub process reported running on each cpu, when the sink wants the stops
+    unsigned int loadThreads; // threads parsing the trace (-j)
+    unsigned int pipelined; // parse the trace and write the events on threads of their own (-P)
+    void * hStream; // trace read by the parser thread
+    void * hTraceRing; // processes parsed for the simulation
+    pthread_t parser;
+    unsigned int parserStarted;
+    unsigned int traceDone; // the parser thread handed over the whole trace
+    unsigned int failed; // the run stopped on an invalid process
+    unsigned int embedded; // the processes are fed by the caller (cpuFeed)
+    CPUHOOKS hooks; // callbacks of an embedded cpu
+    void * hCompleted; // processes whose sub process completed on the previous tick
+    void * hFinished; // processes finishing on the current tick
+#ifdef PROFILE
+    void * hProfile; // phase timers
+#endif
 } CPUINFO;
 
+// Queue profile of a cpu after the first pending sub processes, used to size uneven splits
+typedef struct {
+    unsigned long long max; // longest remaining time among them
+    unsigned long long before; // sum of their remaining times
+} SPLITSEG;
+
+// Dependency of a process read from the trace
+typedef struct {
+    void * hProc;
+    unsigned int pid; // pid of the predecessor
+} DEPENDENCY;
+
+// Define struct for a line handed from the parser thread to the simulation (-P)
+typedef struct {
+    TRACELINE line; // the tenant is a copy owned by the record, the after= pids are not kept
+    unsigned int failed; // reading the trace failed (last record, without a process)
+} PIPEREC;
+
+// Define struct for the loader state kept between the chunks of the trace
+typedef struct {
+    CPUINFO * info;
+    DEPENDENCY * deps; // dependencies are linked once every process is known
+    size_t depCount;
+    size_t depSize;
+} LOADSTATE;
+
+// Maps a key (pid or handle) to a process
+typedef struct {
+    void * hProc;
+    unsigned long long key;
+    size_t index; // position in the trace order
+} PROCREF;
+
 // Helper functions declaration
 
+// Reads the arguments and creates the cpu, embedded in another program if it has hooks
+// Returns the pointer on success
+// Returns NULL if the options are invalid or failed
+static CPUINFO * cpuCreate(int argc, char ** argv, const CPUHOOKS * hooks);
+
+// Reports an error message to the error hook of an embedded cpu, or to stderr
+static void cpuReport(CPUINFO * info, const char * format, ...);
+
+// Checks the process of a line added while the simulation runs (pipelined and embedded runs)
+// Returns 1 if it can follow the processes added so far
+// Returns 0 otherwise
+static int cpuCheckLine(CPUINFO * info, const TRACELINE * line);
+
 // Loads processes from file
 static void loadProcesses(CPUINFO * cpuInfo);
 
+// Adds the processes of a chunk of the trace to info->hProcs, in order
+// Returns 1 on success
+// Returns 0 if a line is invalid or failed
+static int cpuLoadChunk(void * context, void * hChunk);
+
+// Adds the process of a line of the trace to info->hProcs, with its tenant
+// Returns 1 on success
+// Returns 0 if the line is invalid or failed (the process is deleted if it was not added)
+static int cpuAddLine(CPUINFO * info, const TRACELINE * line, void * hProc);
+
+// Opens the trace, with a hint if the build cannot decompress it
+// Returns the stream on success
+// Returns NULL if failed
+static void * cpuOpenTrace(CPUINFO * info);
+
+// Starts the parser thread of a pipelined run (-P), info->hProcs is filled as the simulation runs
+// Sets info->hProcs to NULL if failed
+static void cpuStartParser(CPUINFO * info);
+
+// Stops the parser thread and deletes the processes it parsed that were not taken
+static void cpuStopParser(CPUINFO * info);
+
+// Parses the trace into info->hTraceRing (parser thread entry)
+static void * cpuParse(void * hInfo);
+
+// Hands the lines of a chunk over to the simulation (parser thread)
+// Returns 1 on success
+// Returns 0 if the simulation stopped taking them
+static int cpuPipeChunk(void * context, void * hChunk);
+
+// Takes the processes parsed so far until one arrives after the given time (pipelined runs)
+// Returns 1 on success
+// Returns 0 if the trace is invalid for a pipelined run or failed
+static int cpuPull(CPUINFO * info, unsigned long long time);
+
+// Links the dependencies read from the trace to the processes
+// Returns 1 on success
+// Returns 0 if a predecessor is unknown or failed
+static int linkDependencies(CPUINFO * info, DEPENDENCY * deps, size_t count);
+
+// Compares two process references by key
+static int procRefCompare(const void * a, const void * b);
+
+// Compares two process references by tenant, then by key
+static int procRefTenantCompare(const void * a, const void * b);
+
+// Computes the critical path of the dependency graph: the priority of every process becomes the
+// length of the longest chain of work from its start, and info->criticalBound the makespan lower
+// bound of the chains that start at the arrival times
+// Returns 1 on success
+// Returns 0 if the dependencies have a cycle or failed
+static int cpuCriticalPath(CPUINFO * info);
+
+// Releases the successors of a finished process whose predecessors all finished
+static void cpuRelease(CPUINFO * info, void * hProc, unsigned long long time);
+
+// Queues the sub processes whose I/O burst completed again on their processor
+// Returns 1 on success
+// Returns 0 if failed
+static int cpuWake(CPUINFO * info, unsigned long long time);
+
+// Gets the memory demand of each sub process of a process
+static unsigned long long cpuSubMemory(void * hProc);
+
+// Ranks the cpus with room for the memory of a process into info->ranked and reserves it
+// Returns 1 on success
+// Returns 0 if the process does not fit
+static int cpuReserve(CPUINFO * info, void * hProc, unsigned long long time);
+
+// Places the processes waiting for memory that fit now, in the order they were ready
+// Returns 1 on success
+// Returns 0 if failed
+static int cpuAdmit(CPUINFO * info, unsigned long long time);
+
+// Appends a process to the processes waiting for memory
+// Returns 1 on success
+// Returns 0 if failed
+static int cpuWaitMemory(CPUINFO * info, void * hProc, unsigned long long time);
+
+// Queues the sub processes of a process on the cpus ranked in info->ranked
+// Returns 1 on success
+// Returns 0 if failed
+static int cpuPlace(CPUINFO * info, void * hProc);
+
+// Finds the index of a tenant by name, adding the tenant if it is new
+// Returns 1 on success
+// Returns 0 if failed
+static int cpuTenant(CPUINFO * info, const char * name, unsigned int * pTenant);
+
+// Prints the throughput, share of the cpus and turnaround percentiles of each tenant
+static void cpuTenantStats(CPUINFO * info);
+
+// Computes the best analytic lower bound of the makespan of the processes loaded
+// Returns the bound, 0 if there is no process
+static unsigned long long cpuMakespanBound(CPUINFO * info);
+
+// Assigns a sub process of an arriving process to a processor, critical path first
+// The sub process preempts the current one if its critical path is longer, otherwise it is queued
+// by critical path, then remaining time and pid
+// Returns 1 on success
+// Returns 0 if failed
+static int cpuAssignCP(void * processor, void * hSubProc);
+
+// Copies an argument string
+// Returns NULL if failed
+static char * copyArgument(const char * argument);
+
+// Reads a number from 0 to max without a sign, the whole argument unless psEnd is given, which then
+// gets the end of the number
+// Returns 1 on success
+// Returns 0 if the argument does not start with such a number
+static int readNumber(const char * argument, unsigned long long max, unsigned long long * pValue, const char ** psEnd);
+
+// Assigns a sub process of an arriving process to a processor with the shortest remaining time policy
+// Returns 1 on success
+// Returns 0 if failed
+static int cpuAssignSRT(void * processor, void * hSubProc);
+
+// Sizes the sub processes of a parallel process so that they are predicted to finish together
+// on the cpus ranked for them, keeping the total work plus one tick of synchronisation each
+// Returns the predicted turnaround saved against the even split
+static double cpuSplitUneven(CPUINFO * info, void * hProc, size_t subs);
+
+// Predicts the ticks a new sub process of the given size needs to finish on a cpu
+static unsigned long long cpuSplitFinish(const SPLITSEG * segs, size_t count, unsigned long long current, unsigned long long size);
+
+// Finds the largest sub process that finishes within the given ticks on a cpu
+// Returns 0 if none does
+static unsigned long long cpuSplitLargest(const SPLITSEG * segs, size_t count, unsigned long long current, unsigned long long ticks);
+
+// Queues a sub process by remaining time and pid, without preempting the current one
+// Returns 1 on success
+// Returns 0 if failed
+static int cpuQueueSRT(void * processor, void * hSubProc);
+
+// Collects the processes arriving at the given time,
+// sorted from shortest to longest execution (ties broken by pid)
+// Returns the number of arriving processes stored in info->hArrivals
+static size_t cpuArrivals(CPUINFO * info, unsigned long long time);
+
+// Gets the sort rank of an arriving process: its execution time, or with -d the complement of its
+// critical path (wide selects the 64 bit complement, used when a rank does not fit in 32 bits)
+static unsigned long long cpuArrivalRank(CPUINFO * info, void * hProc, int wide);
+
+// Doubles the capacity of the arrival scratch arrays
+// Returns 1 on success
+// Returns 0 if failed
+static int cpuGrowArrivals(CPUINFO * info);
+
+// Schedules the arriving processes with the shortest remaining time policy
+// using a ranking specialised for a fixed number of processors
+static size_t cpuScheduleFixed(CPUINFO * info, unsigned long long time, void (*rank)(CPUINFO *, void **));
+
+// Writes the first bytes of a recorded output to stdout
+// Returns 1 on success
+// Returns 0 if failed
+static int copyOutputPrefix(const char * fileName, unsigned long long bytes);
+
 #define INFO(h) if (!h) { return 0; } CPUINFO * info = (CPUINFO*)h;
 #define INFON(h) if (!h) { return; } CPUINFO * info = (CPUINFO*)h;
 
@@ -23,19 +335,50 @@ static void loadProcesses(CPUINFO * cpuInfo);
 // Returns the pointer of the CPUINFO struct if the options are valid and read successfully.
 // Returns NULL otherwise.
 void * cpuInit(int argc, char** argv) {
+    return cpuCreate(argc, argv, NULL);
+}
+
+// initialize a cpu with the arguments, fed by the caller instead of a trace
+void * cpuInitEmbedded(int argc, char ** argv, const CPUHOOKS * hooks) {
+    if (!hooks || !hooks->event || !hooks->error) {
+        return NULL;
+    }
+
+    return cpuCreate(argc, argv, hooks);
+}
+
+// Reads the arguments and creates the cpu
+static CPUINFO * cpuCreate(int argc, char ** argv, const CPUHOOKS * hooks) {
      CPUINFO* info = (CPUINFO*)calloc(1, sizeof(CPUINFO));
 
     if (info == NULL) {
-        fprintf(stderr, "Failed to allocate memory for cpu info.\n");
+        if (hooks) {
+            hooks->error(hooks->context, "Failed to allocate memory for cpu info.");
+        } else {
+            fprintf(stderr, "Failed to allocate memory for cpu info.\n");
+        }
         return NULL;
     }
 
+    if (hooks) {
+        info->embedded = 1;
+        info->hooks = *hooks;
+    }
+
+#ifdef PROFILE
+    info->hProfile = profileCreate();
+#endif
+
     int options = 0x0;
+    info->checkpointAt = -1;
+    info->divergeAt = -1;
+    info->gangPolicy = -1;
+    info->loadThreads = 1;
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-f") == 0) {
             if (i + 1 == argc) {
-                fprintf(stderr, "-f option expects an input file name.\n");
+                cpuReport(info, "-f option expects an input file name.\n");
                 cpuDelete(info);
                 return NULL;
             }
@@ -43,7 +386,7 @@ void * cpuInit(int argc, char** argv) {
             info->processListFile = (char *)calloc(len + 1, sizeof(char));
             strcpy(info->processListFile, argv[i+1]); // copy input to string to info
             if (info->processListFile == NULL) {
-                fprintf(stderr, "Failed to allocate memory for process list file.\n");
+                cpuReport(info, "Failed to allocate memory for process list file.\n");
                 cpuDelete(info);
                 return NULL;
             }
@@ -52,285 +395,782 @@ void * cpuInit(int argc, char** argv) {
             i++; // skip
         } else if (strcmp(argv[i], "-p") == 0) {
             if (i + 1 == argc) {
-                fprintf(stderr, "-p option expects an input on the number of processors.\n");
+                cpuReport(info, "-p option expects an input on the number of processors.\n");
+                cpuDelete(info);
+                return NULL;
+            }
+            unsigned long long processors = 0;
+            if (!readNumber(argv[i+1], UINT_MAX, &processors, NULL)) {
+                cpuReport(info, "-p option expects a number of processors.\n");
                 cpuDelete(info);
                 return NULL;
             }
-            info->processors = atoi(argv[i+1]);
+            info->processors = (unsigned int)processors;
             i++; // skip
             options |= 0x2; // flag -p is completed
         } else if (strcmp(argv[i], "-c") == 0) {
             info->useOwnScheduler = 1;
+        } else if (strcmp(argv[i], "-u") == 0) {
+            info->unevenSplit = 1;
+        } else if (strcmp(argv[i], "-d") == 0) {
+            info->criticalPath = 1;
+        } else if (strcmp(argv[i], "-w") == 0) {
+            info->fairShare = 1;
+        } else if (strcmp(argv[i], "-P") == 0) {
+            info->pipelined = 1;
+        } else if (strcmp(argv[i], "-L") == 0) {
+            info->reportBound = 1;
+        } else if (strcmp(argv[i], "-o") == 0) {
+            int binary = i + 1 < argc && strncmp(argv[i+1], "binary:", 7) == 0 && argv[i+1][7];
+            if (i + 1 == argc || (strcmp(argv[i+1], "text") != 0 && strcmp(argv[i+1], "interval") != 0 && !binary)) {
+                cpuReport(info, "-o option expects an output format (text, interval or binary:<file>).\n");
+                cpuDelete(info);
+                return NULL;
+            }
+            if (binary) {
+                free(info->eventFile);
+                info->eventFile = copyArgument(argv[i+1] + 7);
+                if (!info->eventFile) {
+                    cpuReport(info, "Failed to allocate memory for file name.\n");
+                    cpuDelete(info);
+                    return NULL;
+                }
+                info->outputFormat = SINK_BINARY;
+            } else {
+                info->outputFormat = strcmp(argv[i+1], "interval") == 0 ? SINK_INTERVAL : SINK_TEXT;
+            }
+            i++; // skip
+        } else if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "-l") == 0) {
+            if (i + 1 == argc) {
+                cpuReport(info, "%s option expects a file name.\n", argv[i]);
+                cpuDelete(info);
+                return NULL;
+            }
+            char * fileName = copyArgument(argv[i+1]);
+            if (!fileName) {
+                cpuReport(info, "Failed to allocate memory for file name.\n");
+                cpuDelete(info);
+                return NULL;
+            }
+            if (argv[i][1] == 's') {
+                free(info->snapshotFile);
+                info->snapshotFile = fileName;
+            } else if (argv[i][1] == 'r') {
+                free(info->resumeFile);
+                info->resumeFile = fileName;
+            } else {
+                free(info->prefixFile);
+                info->prefixFile = fileName;
+            }
+            i++; // skip
+        } else if (strcmp(argv[i], "-m") == 0) {
+            if (i + 1 == argc) {
+                cpuReport(info, "-m option expects a comma separated list of time quanta.\n");
+                cpuDelete(info);
+                return NULL;
+            }
+            // one quantum per level, from the highest priority to the lowest
+            const char * sQuantum = argv[i+1];
+            info->mlfqLevels = 0;
+            while (*sQuantum && info->mlfqLevels < MLFQ_MAX_LEVELS) {
+                const char * sEnd = NULL;
+                unsigned long long quantum = 0;
+                if (!readNumber(sQuantum, UINT_MAX, &quantum, &sEnd) || quantum == 0 || (*sEnd && *sEnd != ',')) {
+                    break;
+                }
+                info->mlfqQuanta[info->mlfqLevels++] = (unsigned int)quantum;
+                sQuantum = *sEnd ? sEnd + 1 : sEnd;
+            }
+            if (*sQuantum || info->mlfqLevels == 0) {
+                cpuReport(info, "-m option expects up to %d positive time quanta separated by commas.\n", MLFQ_MAX_LEVELS);
+                cpuDelete(info);
+                return NULL;
+            }
+            i++; // skip
+        } else if (strcmp(argv[i], "-j") == 0) {
+            unsigned long long threads = 0;
+            if (i + 1 == argc || !readNumber(argv[i+1], 1024, &threads, NULL) || threads == 0) {
+                cpuReport(info, "-j option expects a number of threads from 1 to 1024.\n");
+                cpuDelete(info);
+                return NULL;
+            }
+            info->loadThreads = (unsigned int)threads;
+            i++; // skip
+        } else if (strcmp(argv[i], "-g") == 0) {
+            if (i + 1 == argc || (strcmp(argv[i+1], "hold") != 0 && strcmp(argv[i+1], "backfill") != 0)) {
+                cpuReport(info, "-g option expects a policy for the waiting cpus (hold or backfill).\n");
+                cpuDelete(info);
+                return NULL;
+            }
+            info->gangPolicy = strcmp(argv[i+1], "hold") == 0 ? GANG_HOLD : GANG_BACKFILL;
+            i++; // skip
+        } else if (strcmp(argv[i], "-M") == 0) {
+            const char * sEnd = NULL;
+            unsigned long long group = 1;
+            if (i + 1 == argc || !readNumber(argv[i+1], ~0ULL, &info->memoryCapacity, &sEnd) || info->memoryCapacity == 0 ||
+                (*sEnd && (*sEnd != ':' || !readNumber(sEnd + 1, UINT_MAX, &group, NULL))) || group == 0) {
+                cpuReport(info, "-M option expects a memory capacity and an optional number of cpus sharing it (capacity:cpus).\n");
+                cpuDelete(info);
+                return NULL;
+            }
+            info->memoryGroup = (unsigned int)group;
+            i++; // skip
+        } else if (strcmp(argv[i], "-y") == 0) {
+            if (i + 1 == argc) {
+                cpuReport(info, "-y option expects a cold cache window and an optional maximum penalty.\n");
+                cpuDelete(info);
+                return NULL;
+            }
+            const char * sEnd = NULL;
+            unsigned long long window = 0, max = 0;
+            if (!readNumber(argv[i+1], UINT_MAX, &window, &sEnd) || window == 0 ||
+                (*sEnd && (*sEnd != ',' || !readNumber(sEnd + 1, UINT_MAX, &max, NULL)))) {
+                cpuReport(info, "-y option expects a positive cold cache window and an optional maximum penalty (window,max).\n");
+                cpuDelete(info);
+                return NULL;
+            }
+            info->coldWindow = (unsigned int)window;
+            info->coldMax = (unsigned int)max;
+            i++; // skip
+        } else if (strcmp(argv[i], "-k") == 0 || strcmp(argv[i], "-K") == 0 || strcmp(argv[i], "-t") == 0 ||
+                   strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "-x") == 0) {
+            if (i + 1 == argc) {
+                cpuReport(info, "%s option expects a number of ticks.\n", argv[i]);
+                cpuDelete(info);
+                return NULL;
+            }
+            // ticks of the simulation for -k and -t, a period or a cost for the others
+            unsigned long long ticks = 0;
+            int simTime = argv[i][1] == 'k' || argv[i][1] == 't';
+            if (!readNumber(argv[i+1], simTime ? LLONG_MAX : UINT_MAX, &ticks, NULL)) {
+                cpuReport(info, "%s option expects a number of ticks from 0 to %llu.\n", argv[i],
+                          simTime ? (unsigned long long)LLONG_MAX : (unsigned long long)UINT_MAX);
+                cpuDelete(info);
+                return NULL;
+            }
+            if (argv[i][1] == 'k') {
+                info->checkpointAt = (long long)ticks;
+            } else if (argv[i][1] == 't') {
+                info->divergeAt = (long long)ticks;
+            } else if (argv[i][1] == 'b') {
+                info->mlfqBoost = (unsigned int)ticks;
+            } else if (argv[i][1] == 'x') {
+                info->switchCost = (unsigned int)ticks;
+            } else {
+                info->checkpointPeriod = (unsigned int)ticks;
+            }
+            i++; // skip
         } else {
             // skip undefined commands
         }
     }
 
     // check if all options are read from the argument.
-    if (!(options & 0x3)) {
+    if (info->embedded ? !(options & 0x2) : !(options & 0x3)) {
+        cpuReport(info, "Process scheduler lacks one or more options from the arguments.\n");
         cpuDelete(info);
-        fprintf(stderr, "Process scheduler lacks one or more options from the arguments.\n");
         return NULL;
     }
 
     if (info->processors == 0) {
+        cpuReport(info, "No processor to be made.\n");
         cpuDelete(info);
-        fprintf(stderr, "No processor to be made.\n");
         return NULL;
     }
 
-    // load processes into procs list
-    loadProcesses(info);
-    if (info->hProcs == NULL) {
+    if ((info->checkpointAt >= 0 || info->checkpointPeriod) && !info->snapshotFile) {
+        cpuReport(info, "Checkpoints need a snapshot file (-s).\n");
         cpuDelete(info);
-        fprintf(stderr, "Failed to create list of processes.\n");
         return NULL;
     }
 
-    // create list of processes as queue for each core
-    info->hProcessors = listCreate();
-    if (info->hProcessors == NULL) {
+    if ((info->divergeAt >= 0 || info->prefixFile) && !info->resumeFile) {
+        cpuReport(info, "What-if runs need a snapshot file to resume from (-r).\n");
         cpuDelete(info);
-        fprintf(stderr, "Failed to create cores.\n");
         return NULL;
     }
 
-    // create the processors
-    void * processor = NULL;
-    for (unsigned int i = 0; i < info->processors; i++) {
-        
-        processor = processorCreate(i);
-        if (!processor) {
-            cpuDelete(info);
-            fprintf(stderr, "Failed to create processor.\n");
-            return NULL;
-        }
+    if (info->mlfqLevels && info->useOwnScheduler) {
+        cpuReport(info, "The feedback queues (-m) replace the scheduler and cannot be combined with -c.\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-        listInsert(info->hProcessors, i, processor);
+    if (info->mlfqLevels && (info->snapshotFile || info->resumeFile)) {
+        cpuReport(info, "Snapshots do not record the feedback queues (-m).\n");
+        cpuDelete(info);
+        return NULL;
     }
 
+    if (info->gangPolicy >= 0 && (info->useOwnScheduler || info->mlfqLevels)) {
+        cpuReport(info, "Gang scheduling (-g) extends the default scheduler and cannot be combined with -c or -m.\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-    return info; // done initialization
-}
+    if (info->unevenSplit && (info->useOwnScheduler || info->mlfqLevels)) {
+        cpuReport(info, "Uneven splits (-u) extend the default scheduler and cannot be combined with -c or -m.\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-// delete the cpu
-void cpuDelete(void * cpuHandle) {
-    INFON(cpuHandle)
+    if (info->criticalPath && (info->useOwnScheduler || info->mlfqLevels)) {
+        cpuReport(info, "Critical path placement (-d) extends the default scheduler and cannot be combined with -c or -m.\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-    // Delete process list file
-    if (info->processListFile) {
-        free(info->processListFile);
+    if (info->unevenSplit && (info->snapshotFile || info->resumeFile)) {
+        cpuReport(info, "Snapshots do not record the uneven splits (-u).\n");
+        cpuDelete(info);
+        return NULL;
     }
-    
-    // Delete processes
-    size_t count = listCount(info->hProcs);
-    for (size_t i = 0; i < count; i++) {
-        procDelete(listGet(info->hProcs, i));
+
+    if (info->memoryCapacity && (info->useOwnScheduler || info->mlfqLevels || info->gangPolicy >= 0)) {
+        cpuReport(info, "Memory capacities (-M) extend the default scheduler and cannot be combined with -c, -m or -g.\n");
+        cpuDelete(info);
+        return NULL;
     }
-    listDelete(info->hProcs);
 
-    // Delete processors
-    count = listCount(info->hProcessors);
-    for (size_t i = 0; i < count; i++) {
-        processorDelete(listGet(info->hProcessors, i));
+    if (info->fairShare && (info->useOwnScheduler || info->mlfqLevels || info->gangPolicy >= 0 ||
+                            info->criticalPath || info->unevenSplit || info->memoryCapacity)) {
+        cpuReport(info, "Fair sharing (-w) orders the cpu queues itself and cannot be combined with -c, -m, -g, -d, -u or -M.\n");
+        cpuDelete(info);
+        return NULL;
     }
-    listDelete(info->hProcessors);
 
-    free(info);
-}
+    if (info->outputFormat != SINK_TEXT && (info->snapshotFile || info->resumeFile)) {
+        cpuReport(info, "Snapshots do not record the open segments of the interval and binary outputs (-o).\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-// run a single frame in the cpu, takes the cpu handle and current time as parameters
-// returns 0 if processes are completed/error 
-// returns 1 otherwise
-int cpuRun(void * cpuHandle, unsigned int time) {
-    INFO(cpuHandle)
+    if (info->fairShare && (info->snapshotFile || info->resumeFile)) {
+        cpuReport(info, "Snapshots do not record the fair share state (-w).\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-    if (info->useOwnScheduler) { 
-        info->unfinished += cpuOwnSchedule(info, time);
-    } else {
-        info->unfinished += cpuSchedule(info, time);
+    if (info->memoryCapacity && (info->snapshotFile || info->resumeFile)) {
+        cpuReport(info, "Snapshots do not record the memory use (-M).\n");
+        cpuDelete(info);
+        return NULL;
     }
 
-    void * finished = listCreate(); 
+    if (info->gangPolicy >= 0 && (info->snapshotFile || info->resumeFile)) {
+        cpuReport(info, "Snapshots do not record the waiting gangs (-g).\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-    if (!finished) { // failed to create list of finished processes
-        return 0;
+    if ((info->switchCost || info->coldWindow) && (info->snapshotFile || info->resumeFile)) {
+        cpuReport(info, "Snapshots do not record the switch costs (-x, -y).\n");
+        cpuDelete(info);
+        return NULL;
     }
 
-    void * running = listCreate();
+    if (info->pipelined && (info->snapshotFile || info->resumeFile || info->criticalPath || info->fairShare)) {
+        cpuReport(info, "Pipelined runs (-P) read the trace while they run and cannot be combined with -s, -r, -d or -w.\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-    if (!running) {
-        listDelete(running);
-        return 0;
+    if (info->embedded && (info->processListFile || info->outputFormat != SINK_TEXT || info->pipelined ||
+                           info->snapshotFile || info->resumeFile || info->criticalPath || info->fairShare)) {
+        cpuReport(info, "Embedded schedulers are fed their processes and report their events to the caller, and cannot be combined with -f, -o, -P, -s, -r, -d or -w.\n");
+        cpuDelete(info);
+        return NULL;
     }
 
-    for (unsigned int i = 0; i < info->processors; i++) {
-        listInsert(running, i, NULL); // populate NULL pointers in the running
+    // load processes into procs list, or start the parser thread that feeds them while the simulation runs
+    // (the caller feeds the processes of an embedded cpu)
+    if (info->embedded) {
+        info->hProcs = listCreate();
+    } else if (info->pipelined) {
+        cpuStartParser(info);
+    } else {
+        loadProcesses(info);
+    }
+    if (info->hProcs == NULL) {
+        cpuReport(info, "Failed to create list of processes.\n");
+        cpuDelete(info);
+        return NULL;
     }
 
-    size_t count = listCount(info->hProcessors);
+    // dependencies between the processes
+    info->hReleased = listCreate();
+    if (!info->hReleased) {
+        cpuReport(info, "Failed to create list of released processes.\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-    // Checked finished processes
-    for (size_t i = 0; i < count; i++) {
-        void * hCurrentSubProc = processorCurrentSubProc(listGet(info->hProcessors, i));
+    if ((info->hasDependencies || info->criticalPath) && !cpuCriticalPath(info)) {
+        cpuReport(info, "The process dependencies have a cycle.\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-        if (!hCurrentSubProc) {
-            continue; 
-        }
+    if (info->hasPhases && info->useOwnScheduler) {
+        cpuReport(info, "I/O bursts (phases=) cannot be combined with -c.\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-        void * hParent = subProcParent(hCurrentSubProc); 
-        if (procRem(hParent) == 0) { // process is done
-            // report to CPU running function
-            // check if hParent is already in the list of finished procs
-            if (!listSearch(finished, hParent, NULL)) {
-                listPush(finished, hParent);
-                info->unfinished--;
-                info->finished++;
-            }
-        }  
+    if (info->hasPhases && (info->snapshotFile || info->resumeFile)) {
+        cpuReport(info, "Snapshots do not record the I/O bursts.\n");
+        cpuDelete(info);
+        return NULL;
     }
 
-    // Execute each processor    
-    for (size_t i = 0; i < count; i++) {
-        processorRun(listGet(info->hProcessors, i), time, running);
+    // activity of the tenants
+    info->tenantActive = (unsigned int *)calloc(info->tenantSize + 1, sizeof(unsigned int));
+    info->tenantContended = (unsigned long long *)calloc(info->tenantSize + 1, sizeof(unsigned long long));
+    if (!info->tenantActive || !info->tenantContended) {
+        cpuReport(info, "Failed to allocate memory for the tenants.\n");
+        cpuDelete(info);
+        return NULL;
     }
 
-    // report finished processes
-    count = listCount(finished);
-    for (size_t i = 0; i < count; i++) {
-        printf("%u,FINISHED,pid=%u,proc_remaining=%d\n", time, procID(listGet(finished, i)), info->unfinished);
+    info->hWoken = listCreate();
+    if (!info->hWoken) {
+        cpuReport(info, "Failed to create list of woken sub processes.\n");
+        cpuDelete(info);
+        return NULL;
     }
 
-    // report running processes
-    for (unsigned int i = 0; i < info->processors; i++) {
-        void * hCurrentSubProc = listGet(running, i);
-        if (!hCurrentSubProc) {
-            continue; // skip if pointer is NULL
-        }
-        void * hParent = subProcParent(hCurrentSubProc); 
-        if (procSubs(hParent) > 1) { // is parallel
-            printf("%d,RUNNING,pid=%u.%u,remaining_time=%d,cpu=%u\n", time, procID(hParent), subProcID(hCurrentSubProc), subProcRem(hCurrentSubProc) + 1, i);
-        } else {
-            printf("%d,RUNNING,pid=%u,remaining_time=%d,cpu=%u\n", time, procID(hParent), subProcRem(hCurrentSubProc) + 1, i);
-        }
+    if (info->hasDependencies && (info->snapshotFile || info->resumeFile)) {
+        cpuReport(info, "Snapshots do not record the process dependencies.\n");
+        cpuDelete(info);
+        return NULL;
     }
-  
-    listDelete(finished);
-    listDelete(running);
 
-    return info->finished != listCount(info->hProcs);    
-}
+    // create list of processes as queue for each core
+    info->hProcessors = listCreate();
+    if (info->hProcessors == NULL) {
+        cpuReport(info, "Failed to create cores.\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-/*
- * New Scheduling Algorithm:
- * The disadvantage of the Shortest Remaining Time Algorithm is that it delays longer
- * processes in favor of the shorter ones.
- */
+    // create the processors
+    void * processor = NULL;
+    for (unsigned int i = 0; i < info->processors; i++) {
+        
+        processor = processorCreate(i);
+        if (!processor) {
+            cpuReport(info, "Failed to create processor.\n");
+            cpuDelete(info);
+            return NULL;
+        }
+        processorSetCosts(processor, info->switchCost, info->coldWindow, info->coldMax);
 
-size_t cpuOwnSchedule(void * hCPU, unsigned int time) {
-    INFO(hCPU)
+        listInsert(info->hProcessors, i, processor);
+    }
 
-    // sort the new processes from shortest to longest
-    void * hArrivingProcs = listCreate();
-    if (!hArrivingProcs) {
-        return 0;
+    // writer of the events
+    if (info->eventFile) {
+        info->hEventFile = fopen(info->eventFile, "wb");
+        if (!info->hEventFile) {
+            cpuReport(info, "Failed to create the event log %s.\n", info->eventFile);
+            cpuDelete(info);
+            return NULL;
+        }
     }
 
-    size_t arriving = 0, insert = 0, count = 0;
+    if (info->embedded) {
+        info->hSink = sinkCreateCallback(info->hooks.event, info->hooks.context, info->processors);
+    } else {
+        info->hSink = sinkCreate(info->outputFormat, info->hEventFile ? info->hEventFile : stdout, info->processors);
+    }
+    if (!info->hSink) {
+        cpuReport(info, "Failed to create the event sink.\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-    unsigned int exec = 0, exec2 = 0;
+    if (info->pipelined && !sinkStartThread(info->hSink)) {
+        cpuReport(info, "Failed to start the writer thread.\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-    void * hProc = NULL;
-    void * hProc2 = NULL;
+    if (sinkWantsStops(info->hSink)) {
+        info->hSegments = (void **)calloc(info->processors, sizeof(void *));
+        if (!info->hSegments) {
+            cpuReport(info, "Failed to allocate memory for the execution segments.\n");
+            cpuDelete(info);
+            return NULL;
+        }
+    }
 
-    unsigned int nextArrival = time;
+    // completion queues
+    info->hCompleted = listCreate();
+    info->hFinished = listCreate();
+    if (!info->hCompleted || !info->hFinished) {
+        cpuReport(info, "Failed to create completion queues.\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-    count = listCount(info->hProcs);
+    // flat arrays used to rank the processors
+    info->loads = (unsigned long long *)calloc(info->processors, sizeof(unsigned long long));
+    info->loadTies = (unsigned long long *)calloc(info->processors, sizeof(unsigned long long));
+    info->loadScratch = (unsigned long long *)calloc(3 * info->processors, sizeof(unsigned long long));
+    info->ranked = (unsigned int *)calloc(info->processors, sizeof(unsigned int));
+    if (!info->loads || !info->loadTies || !info->loadScratch || !info->ranked) {
+        cpuReport(info, "Failed to allocate memory for processor ranking.\n");
+        cpuDelete(info);
+        return NULL;
+    }
 
-    // rank the list of arriving processes from shortest to longest execution
-    for (size_t i = 0; i < count; i++) {
-        hProc = listGet(info->hProcs, i);
+    // select the scheduler
+    // the default policy has specialised engines for the common processor counts,
+    // which need the trace to be sorted by arrival time
+    info->arrivalOrdered = 1;
+    size_t count = listCount(info->hProcs);
+    for (size_t i = 1; i < count && info->arrivalOrdered; i++) {
+        info->arrivalOrdered = procArrivalTime(listGet(info->hProcs, i - 1)) <= procArrivalTime(listGet(info->hProcs, i));
+    }
 
-        // get the next arrival time
-        if (procArrivalTime(hProc) != time) {
-            if (procArrivalTime(hProc) > time) {
-                if (nextArrival == time) {
-                    nextArrival = procArrivalTime(hProc);
-                } else if (procArrivalTime(hProc) < nextArrival) {
-                    nextArrival = procArrivalTime(hProc);
-                }
+    // memory of the cpus, a process that can never fit is rejected
+    if (info->memoryCapacity) {
+        info->hMemory = mempoolCreate(info->processors, info->memoryCapacity, info->memoryGroup);
+        if (!info->hMemory) {
+            cpuReport(info, "Failed to create the memory pools.\n");
+            cpuDelete(info);
+            return NULL;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            void * hProc = listGet(info->hProcs, i);
+            if (!mempoolFitsEmpty(info->hMemory, cpuSubMemory(hProc), procSubs(hProc))) {
+                cpuReport(info, "Process %u needs more memory than the cpus have.\n", procID(hProc));
+                cpuDelete(info);
+                return NULL;
             }
-            continue; 
         }
+    }
 
-        exec = subProcExecTime(listGet(procSubsHandle(hProc), 0));   
+    if (info->fairShare) {
+        info->hFair = fairCreate(info->processors, info->tenantWeights, info->tenants);
+        if (!info->hFair) {
+            cpuReport(info, "Failed to create the fair share state.\n");
+            cpuDelete(info);
+            return NULL;
+        }
+    }
 
-        arriving = listCount(hArrivingProcs);
-        for (insert = 0; insert < arriving; insert++) {
-            hProc2 = listGet(hArrivingProcs, insert);
-            exec2 = subProcExecTime(listGet(procSubsHandle(hProc2), 0));  
+    info->schedule = cpuSchedule;
+    if (info->mlfqLevels) {
+        info->hMlfq = mlfqCreate(info->processors, info->mlfqQuanta, info->mlfqLevels, info->mlfqBoost);
+        if (!info->hMlfq) {
+            cpuReport(info, "Failed to create the feedback queues.\n");
+            cpuDelete(info);
+            return NULL;
+        }
+        info->schedule = cpuMlfqSchedule;
+    } else if (info->useOwnScheduler) {
+        info->schedule = cpuOwnSchedule;
+    } else if (info->gangPolicy >= 0) {
+        // the gangs are launched by the generic engine
+        info->hGang = gangCreate(info->processors, (GANGPOLICY)info->gangPolicy);
+        if (!info->hGang) {
+            cpuReport(info, "Failed to create the gang scheduler.\n");
+            cpuDelete(info);
+            return NULL;
+        }
+    } else if (info->arrivalOrdered && !info->unevenSplit && !info->criticalPath && !info->hMemory && !info->hFair) {
+        switch (info->processors) {
+            case 1: info->schedule = cpuScheduleFast1; break;
+            case 2: info->schedule = cpuScheduleFast2; break;
+            case 4: info->schedule = cpuScheduleFast4; break;
+            default: break;
+        }
+    }
 
-            if (exec < exec2) {
-                break;
-            } else if (exec == exec2) {
-                if (procID(hProc) < procID(hProc2)) {
-                    break;
+    // continue from the latest snapshot, or from the latest one before the divergence point
+    // (a what-if run without an earlier snapshot simply starts from scratch)
+    if (info->resumeFile && info->divergeAt != 0) {
+        unsigned long long snapTime = 0;
+        unsigned long long maxTime = info->divergeAt > 0 ? (unsigned long long)(info->divergeAt - 1) : ~0ULL;
+        if (snapshotLoad(info->resumeFile, maxTime, &snapTime, &info->emitted,
+                         &info->unfinished, &info->finished, info->hProcs, info->hProcessors)) {
+            info->startTime = snapTime + 1;
+
+            // a sub process completed on the snapshot tick is still current on its processor
+            for (size_t i = 0; i < info->processors; i++) {
+                void * hCurrentSubProc = processorCurrentSubProc(listGet(info->hProcessors, i));
+                if (hCurrentSubProc && subProcRem(hCurrentSubProc) == 0 &&
+                    !listSearch(info->hCompleted, subProcParent(hCurrentSubProc), NULL)) {
+                    listPush(info->hCompleted, subProcParent(hCurrentSubProc));
                 }
             }
+        } else if (info->divergeAt < 0) {
+            cpuReport(info, "No usable snapshot in %s.\n", info->resumeFile);
+            cpuDelete(info);
+            return NULL;
+        }
+
+        // reuse the events of the recorded run up to the snapshot
+        if (info->emitted && info->prefixFile && !copyOutputPrefix(info->prefixFile, info->emitted)) {
+            cpuReport(info, "Failed to reuse the output prefix of %s.\n", info->prefixFile);
+            cpuDelete(info);
+            return NULL;
+        }
+    }
+
+    return info; // done initialization
+}
+
+// delete the cpu
+void cpuDelete(void * cpuHandle) {
+    INFON(cpuHandle)
+
+#ifdef PROFILE
+    // report where the simulation time went
+    profileReport(info->hProfile, stderr);
+    profileDelete(info->hProfile);
+#endif
+
+    cpuStopParser(info);
+
+    // Delete process list file
+    if (info->processListFile) {
+        free(info->processListFile);
+    }
+
+    // Delete snapshot file names
+    free(info->snapshotFile);
+    free(info->resumeFile);
+    free(info->prefixFile);
+    free(info->hArrivals);
+    free(info->arrivalKeys);
+    free(info->hArrivalScratch);
+    free(info->arrivalKeyScratch);
+    free(info->loads);
+    free(info->loadTies);
+    free(info->loadScratch);
+    free(info->ranked);
+    mlfqDelete(info->hMlfq);
+    gangDelete(info->hGang);
+    mempoolDelete(info->hMemory);
+    free(info->admission);
+    listDelete(info->hCompleted);
+    listDelete(info->hFinished);
+    listDelete(info->hReleased);
+    listDelete(info->hWoken);
+    sinkDelete(info->hSink);
+    free(info->hSegments);
+    if (info->hEventFile && (ferror(info->hEventFile) | fclose(info->hEventFile))) {
+        cpuReport(info, "Failed to write the event log %s.\n", info->eventFile);
+    }
+    free(info->eventFile);
+    fairDelete(info->hFair);
+    for (unsigned int i = 0; i < info->tenants; i++) {
+        free(info->tenantNames[i]);
+    }
+    free(info->tenantNames);
+    free(info->tenantWeights);
+    free(info->tenantActive);
+    free(info->tenantContended);
+    
+    // Delete processes
+    size_t count = listCount(info->hProcs);
+    for (size_t i = 0; i < count; i++) {
+        procDelete(listGet(info->hProcs, i));
+    }
+    listDelete(info->hProcs);
+
+    // Delete processors
+    count = listCount(info->hProcessors);
+    for (size_t i = 0; i < count; i++) {
+        processorDelete(listGet(info->hProcessors, i));
+    }
+    listDelete(info->hProcessors);
+
+    free(info);
+}
+
+// run a single frame in the cpu, takes the cpu handle and current time as parameters
+// returns 0 if processes are completed/error 
+// returns 1 otherwise
+int cpuRun(void * cpuHandle, unsigned long long time) {
+    INFO(cpuHandle)
+
+    // the processes whose last sub process completed on the previous tick finish now
+    void * finished = info->hCompleted;
+    info->hCompleted = info->hFinished;
+    info->hFinished = finished;
+    listClear(info->hCompleted);
+
+    for (size_t i = 0; i < listCount(finished);) {
+        if (procOutstanding(listGet(finished, i)) != 0) {
+            listRemove(finished, i); // another sub process is still running
+            continue;
+        }
+        info->unfinished--;
+        info->finished++;
+        cpuRelease(info, listGet(finished, i), time);
+
+        void * hProc = listGet(finished, i);
+        if (info->tenantActive[procTenant(hProc)] > 0 && --info->tenantActive[procTenant(hProc)] == 0) {
+            info->activeTenants--;
+        }
+
+        // the memory of the process is free for the processes waiting for it
+        if (info->hMemory && procMemory(hProc)) {
+            void * hSubProcs = procSubsHandle(hProc);
+            size_t subs = listCount(hSubProcs);
+            for (size_t j = 0; j < subs; j++) {
+                mempoolRelease(info->hMemory, subProcCPU(listGet(hSubProcs, j)), cpuSubMemory(hProc));
+            }
+            info->memoryFreed = 1;
+        }
+        i++;
+    }
+
+    // the sub processes back from I/O compete with the arrivals
+    if (info->hasPhases && !cpuWake(info, time)) {
+        return 0;
+    }
+
+    // their successors are scheduled with the arrivals
+    info->unfinished += info->schedule(info, time);
+
+    void * running = listCreate();
+
+    if (!running) {
+        listDelete(running);
+        return 0;
+    }
+
+    for (unsigned int i = 0; i < info->processors; i++) {
+        listInsert(running, i, NULL); // populate NULL pointers in the running
+    }
+
+    size_t count = listCount(info->hProcessors);
+
+    // Execute each processor    
+    for (size_t i = 0; i < count; i++) {
+        PROFILE_START(runStart)
+        processorRun(listGet(info->hProcessors, i), time, running, info->hCompleted);
+        PROFILE_STOP(info->hProfile, PROF_PROCESSOR_RUN, runStart)
+    }
+
+    // cpu time of the tenants while they compete
+    if (info->hasTenants && info->activeTenants > 1) {
+        for (unsigned int i = 0; i < info->processors; i++) {
+            void * hCurrentSubProc = listGet(running, i);
+            if (hCurrentSubProc) {
+                info->tenantContended[procTenant(subProcParent(hCurrentSubProc))]++;
+                info->contended++;
+            }
+        }
+    }
+
+    PROFILE_START(outputStart)
+
+    EVENT event;
+
+    // report finished processes
+    count = listCount(finished);
+    for (size_t i = 0; i < count; i++) {
+        event.time = time;
+        event.type = EVENT_FINISHED;
+        event.pid = procID(listGet(finished, i));
+        event.sub = EVENT_NOSUB;
+        event.cpu = 0;
+        event.value = info->unfinished;
+        info->emitted += sinkWrite(info->hSink, &event);
+    }
+
+    // report the sub processes that stopped running since they were reported
+    if (info->hSegments) {
+        for (unsigned int i = 0; i < info->processors; i++) {
+            void * hSubProc = info->hSegments[i];
+            if (!hSubProc) {
+                continue;
+            }
+
+            int stopped = subProcRem(hSubProc) == 0 || processorCurrentSubProc(listGet(info->hProcessors, i)) != hSubProc;
+            if (stopped || listGet(running, i)) { // dispatched again on this tick
+                event.time = stopped ? subProcLastRun(hSubProc) : time - 1;
+                event.type = EVENT_STOPPED;
+                event.pid = procID(subProcParent(hSubProc));
+                event.sub = procSubs(subProcParent(hSubProc)) > 1 ? subProcID(hSubProc) : EVENT_NOSUB;
+                event.cpu = i;
+                event.value = subProcRem(hSubProc) == 0 ? STOP_COMPLETED : (subProcIOTime(hSubProc) > 0 ? STOP_BLOCKED : STOP_PREEMPTED);
+                info->emitted += sinkWrite(info->hSink, &event);
+                info->hSegments[i] = NULL;
+            }
         }
+    }
 
-        listInsert(hArrivingProcs, insert, hProc);
+    // report running processes
+    for (unsigned int i = 0; i < info->processors; i++) {
+        void * hCurrentSubProc = listGet(running, i);
+        if (!hCurrentSubProc) {
+            continue; // skip if pointer is NULL
+        }
+        void * hParent = subProcParent(hCurrentSubProc); 
+        event.time = time;
+        event.type = EVENT_RUNNING;
+        event.pid = procID(hParent);
+        event.sub = procSubs(hParent) > 1 ? subProcID(hCurrentSubProc) : EVENT_NOSUB; // is parallel
+        event.cpu = i;
+        event.value = subProcRem(hCurrentSubProc) + 1;
+        info->emitted += sinkWrite(info->hSink, &event);
+
+        if (info->hSegments) {
+            info->hSegments[i] = hCurrentSubProc;
+        }
     }
 
-    arriving = listCount(hArrivingProcs);
+    PROFILE_STOP(info->hProfile, PROF_OUTPUT, outputStart)
+  
+    listDelete(running);
+
+    return !info->failed && info->finished != listCount(info->hProcs);    
+}
+
+/*
+ * New Scheduling Algorithm:
+ * The disadvantage of the Shortest Remaining Time Algorithm is that it delays longer
+ * processes in favor of the shorter ones.
+ */
+
+size_t cpuOwnSchedule(void * hCPU, unsigned long long time) {
+    INFO(hCPU)
+
+    // get the new processes sorted from shortest to longest
+    PROFILE_START(arrivalStart)
+    size_t arriving = cpuArrivals(info, time), insert = 0, count = 0;
+    PROFILE_STOP(info->hProfile, PROF_ARRIVALS, arrivalStart)
 
     // for each new process
     for (size_t i = 0; i < arriving; i++) {
-        hProc = listGet(hArrivingProcs, i);
+        void * hProc = info->hArrivals[i];
 
-        void * cpuList = listCreate();
+        PROFILE_START(rankStart)
 
-        // get a list of processors from least to greatest waiting time
+        // rank the processors from least to greatest waiting time,
+        // ties broken by the shorter remaining time and then the cpu id
+        count = listCount(procSubsHandle(hProc));
         for (size_t j = 0; j < info->processors; j++) {
             void * processor = listGet(info->hProcessors, j);
-            
-            double f = 0;
-            count = listCount(processorPending(processor));
-            for (size_t k = 0; k < count; k++) {
-                f += subProcWaiting(listGet(processorPending(processor), k), time);
-            }
-            
-            // find the insertion point
-            size_t cpuCount = listCount(cpuList);
-            for (insert = 0; insert < cpuCount; insert++) {
-                void * processor2 = listGet(cpuList, insert);
-                
-                double f2 = 0;
-                count = listCount(processorPending(processor2));
-                for (size_t k = 0; k < count; k++) {
-                    f2 += subProcWaiting(listGet(processorPending(processor2), k), time);
-                }
-
-                if (f < f2) {
-                    break;
-                } else if (f == f2) { // in case of tie on the waiting time, break tie with the shorter remaining time
-                    if (processorRemainingTime(processor) < processorRemainingTime(processor2)) {
-                        break;
-                    } else if (processorRemainingTime(processor) == processorRemainingTime(processor2)) {
-                        if (processorID(processor) < processorID(processor2)) {
-                            break;
-                        }
-                    }
-                }
-            }
 
-            listInsert(cpuList, insert, processor);
+            info->loads[j] = processorWaiting(processor, time);
+            info->loadTies[j] = processorRemainingTime(processor);
         }
+        selectLeastPair(info->loads, info->loadTies, info->processors, count, info->ranked, info->loadScratch);
+
+        PROFILE_STOP(info->hProfile, PROF_RANKING, rankStart)
+        PROFILE_START(pendingStart)
 
         // assign the new subprocesses to the CPUs
-        count = listCount(procSubsHandle(hProc));
         for (size_t j = 0; j < count; j++) {
-            void * processor = listGet(cpuList, j);
+            void * processor = listGet(info->hProcessors, info->ranked[j]);
             void * pending = processorPending(processor);
             void * subProc = listGet(procSubsHandle(hProc), j);
             void * pendingSP = NULL;
@@ -359,10 +1199,10 @@ size_t cpuOwnSchedule(void * hCPU, unsigned int time) {
                 }
             }
             
-            listInsert(pending, insert, subProc);
+            processorEnqueue(processor, insert, subProc);
         }
 
-        listDelete(cpuList);
+        PROFILE_STOP(info->hProfile, PROF_PENDING, pendingStart)
     }
 
     return arriving;
@@ -381,174 +1221,164 @@ size_t cpuOwnSchedule(void * hCPU, unsigned int time) {
  * 3. The sub process with least execution time will be prioritized by the processor.
  */
 
-size_t cpuSchedule(void * hCPU, unsigned int time) {
+size_t cpuSchedule(void * hCPU, unsigned long long time) {
     INFO(hCPU)
 
-    // get the list of arriving sub processes and sort them from fastest to slowest execution time
-    void * hArrivingProcs = listCreate();
-    if (!hArrivingProcs) { // failed to create list of arriving processes
+    // the processes waiting for memory go first
+    if (info->hMemory && !cpuAdmit(info, time)) {
         return 0;
     }
 
-    unsigned int fastest = 0, slowest = 0, exec = 0, exec2 = 0;
-    size_t count = listCount(info->hProcs), insert = 0, arriving = 0;
-    void * hProc = NULL;
-    void * hProc2 = NULL;
-    void * hSubProc = NULL;
-    void * hSubProc2 = NULL;
+    // the fair queues hand their earliest sub processes to the idle cpus
+    if (info->hFair && !fairDispatch(info->hFair, info->hProcessors)) {
+        return 0;
+    }
 
-    for (size_t i = 0; i < count; i++) {
-        hProc = listGet(info->hProcs, i);
+    // get the arriving processes sorted from fastest to slowest execution time
+    PROFILE_START(arrivalStart)
+    size_t arriving = cpuArrivals(info, time);
+    PROFILE_STOP(info->hProfile, PROF_ARRIVALS, arrivalStart)
 
-        if (procArrivalTime(hProc) != time) {
-            continue; // skip processes not arriving
-        }
+    // assign the processes to the CPUs
+    size_t cpusToAssign = 0;
+    
+    for (size_t i = 0; i < arriving; i++) {
+        void * hProc = info->hArrivals[i];
+        cpusToAssign = procSubs(hProc);
 
-        hSubProc = listGet(procSubsHandle(hProc), 0); // get first sub process
-        exec = subProcExecTime(hSubProc);
-        arriving = listCount(hArrivingProcs);
+        PROFILE_START(rankStart)
 
-        if (arriving == 0) { // first arriving proc
-            insert = 0;
-            fastest = exec;
-            slowest = exec;
-        } else {
-            if (exec < fastest) {
-                insert = 0; // insert to first of array
-                fastest = exec; 
-            } else if (exec > slowest) { 
-                insert = arriving; // insert to the end of the list
-                slowest = exec;
-            } else {
-                // search for the best insertion point
-                for (insert = 0; insert < arriving; insert++) {
-                    hProc2 = listGet(hArrivingProcs, insert);
-                    hSubProc2 = listGet(procSubsHandle(hProc2), 0); 
-                    exec2 = subProcExecTime(hSubProc2);
-
-                    if (exec == exec2) {
-                        if (procID(hProc) < procID(hProc2)) {
-                            break;
-                        }
-                    } else if (exec < exec2) {
-                        break; // insert here
-                    }
+        if (info->hMemory) {
+            // only the cpus with room for the process, which otherwise waits behind the waiting ones
+            if (info->admissionCount > 0 || !cpuReserve(info, hProc, time)) {
+                if (!cpuWaitMemory(info, hProc, time)) {
+                    return i;
                 }
+                PROFILE_STOP(info->hProfile, PROF_RANKING, rankStart)
+                continue;
+            }
+        } else if (info->hFair) {
+            // spread the work of each tenant, then the cpus with least remaining time
+            fairRank(info->hFair, info->hProcessors, time, procTenant(hProc), cpusToAssign, info->ranked);
+        } else {
+            // rank the cpus from least remaining time to greatest remaining time
+            for (size_t j = 0; j < info->processors; j++) {
+                info->loads[j] = processorRemainingTime(listGet(info->hProcessors, j));
             }
+            selectLeast(info->loads, info->processors, cpusToAssign, info->ranked, info->loadScratch);
         }
 
-        if (!listInsert(hArrivingProcs, insert, hProc)) { // failed to insert processes to the list of arriving processes
-            listDelete(hArrivingProcs); // clean up memory for the list of arriving processes
-            return 0;
+        if (info->unevenSplit && cpusToAssign > 1) {
+            info->splitGain += cpuSplitUneven(info, hProc, cpusToAssign);
+            info->splitProcs++;
         }
-    }
-    arriving = listCount(hArrivingProcs); // update count of arriving procs
 
-    // assign the processes to the CPUs
-    size_t cpusToAssign = 0, cpuListCount;
-    
-    for (size_t i = 0; i < arriving; i++) {
-        hProc = listGet(hArrivingProcs, i);
-        cpusToAssign = procSubs(hProc);
+        PROFILE_STOP(info->hProfile, PROF_RANKING, rankStart)
+        PROFILE_START(pendingStart)
 
-        void * cpuList = listCreate();
-        if (!cpuList) { // failed to create list of processors
-            listDelete(hArrivingProcs); // clean up memory
-            return 0;
+        // insert the sub processes to the processors
+        if (!cpuPlace(info, hProc)) {
+            return i;
         }
 
-        unsigned int cpuRemTime = 0, cpu2RemTime = 0;
+        PROFILE_STOP(info->hProfile, PROF_PENDING, pendingStart)
+    }
 
-        // make an ordered list of cpus from least remaining time to greatest remaining time
-        for (size_t j = 0; j < info->processors; j++) {
-            cpuListCount = listCount(cpuList);
-            cpuRemTime = processorRemainingTime(listGet(info->hProcessors, j));                    
+    if (info->hGang) {
+        gangDispatch(info->hGang, info->hProcessors);
+    }
 
-            for (insert = 0; insert < cpuListCount; insert++) { // search for insertion point
-                cpu2RemTime = processorRemainingTime(listGet(cpuList, insert));
+    return arriving;
+}
 
-                if (cpuRemTime < cpu2RemTime) { // insert here
-                    break;
-                } else if (cpuRemTime == cpu2RemTime) {
-                    if (processorID(listGet(info->hProcessors, j)) < processorID(listGet(cpuList, insert))) {
-                        break;
-                    }
-                }
-            }
+// schedule the process to the cores with multi-level feedback queues
+/*
+ * Arriving sub processes are assigned like the default scheduler, to the cpus with the least
+ * remaining time, and join the highest priority queue of their cpu. Each cpu then runs the
+ * head of its highest non empty queue for the quantum of that level, demoting it when the
+ * quantum expires, so long processes sink and short ones finish first. The periodic boost
+ * lifts every queued sub process back to the top so long ones cannot starve.
+ */
 
-            if (!listInsert(cpuList, insert, listGet(info->hProcessors, j))) { // failed to insert
-                listDelete(cpuList);
-                listDelete(hArrivingProcs);
-                return 0;
-            }
-        }
+size_t cpuMlfqSchedule(void * hCPU, unsigned long long time) {
+    INFO(hCPU)
 
-        // insert the sub processes to the processors
-        // for each sub process in the ariiving process
-        for (size_t j = 0; j < cpusToAssign; j++) {
-            void * processor = listGet(cpuList, j);
-            void * pending = processorPending(processor);
-            hSubProc = processorCurrentSubProc(processor); // current sub proc of processor
-            hSubProc2 = listGet(procSubsHandle(hProc), j); // sub proc to insert
-            
-            // check if the sub process can replace the current sub process in the processor
-            if (hSubProc) {
-                exec = subProcRem(hSubProc); // check remaining time of current sub process
-                exec2 = subProcExecTime(hSubProc2);
-
-                if (exec2 < exec) {
-                    // put the current sub proc to list of pending processes in the first
-                    listInsert(pending, 0, hSubProc); // set taret to null
-                    listInsert(pending, 0, hSubProc2); // insert the new sub proc at the first
-                    processorClearCurrent(processor);
-                    continue; // skip 
-                } else if (exec == exec2) { // test pid
-                    if (procID(subProcParent(hSubProc2)) < procID(subProcParent(hSubProc2))) {
-                        // put the current sub proc to list of pending processes in the first
-                        listInsert(pending, 0, hSubProc); // set taret to null
-                        listInsert(pending, 0, hSubProc2); // insert the new sub proc at the first
-                        processorClearCurrent(processor);
-                        continue; // skip 
-                    } 
-                }
-            }
+    PROFILE_START(arrivalStart)
+    size_t arriving = cpuArrivals(info, time);
+    PROFILE_STOP(info->hProfile, PROF_ARRIVALS, arrivalStart)
 
-            // insert the sub proc to pending
-            count = listCount(pending);         
-            for (insert = 0; insert < count; insert++) {
-                hSubProc = listGet(pending, insert);
-                exec = subProcRem(hSubProc); // check remaining time of current sub process
-                exec2 = subProcExecTime(hSubProc2);
-                
-                if (exec2 < exec) {
-                    break;
-                } else if (exec2 == exec) {
-                    if (procID(subProcParent(hSubProc2)) < procID(subProcParent(hSubProc))) {
-                        break;
-                    }
-                }
-            }
+    for (size_t i = 0; i < arriving; i++) {
+        void * hProc = info->hArrivals[i];
+        size_t subs = procSubs(hProc);
 
-            if (!listInsert(pending, insert, hSubProc2)) {
-                listDelete(cpuList);
-                listDelete(hArrivingProcs);
-                return 0;
+        PROFILE_START(rankStart)
+
+        // rank the cpus from least remaining time to greatest remaining time, queued work included
+        for (size_t j = 0; j < info->processors; j++) {
+            info->loads[j] = processorRemainingTime(listGet(info->hProcessors, j)) + mlfqLoad(info->hMlfq, j);
+        }
+        selectLeast(info->loads, info->processors, subs, info->ranked, info->loadScratch);
+
+        PROFILE_STOP(info->hProfile, PROF_RANKING, rankStart)
+        PROFILE_START(pendingStart)
+
+        for (size_t j = 0; j < subs; j++) {
+            if (!mlfqPush(info->hMlfq, info->ranked[j], listGet(procSubsHandle(hProc), j))) {
+                return i;
             }
-            
+            subProcSetCPU(listGet(procSubsHandle(hProc), j), info->ranked[j]);
         }
 
-        listDelete(cpuList);
+        PROFILE_STOP(info->hProfile, PROF_PENDING, pendingStart)
     }
 
-    listDelete(hArrivingProcs);
+    // time slicing, a switched in sub process is reported as RUNNING by the processor step
+    for (size_t j = 0; j < info->processors; j++) {
+        mlfqDispatch(info->hMlfq, listGet(info->hProcessors, j), time);
+    }
 
     return arriving;
 }
 
+// Ranks the processors from least to greatest remaining time with fixed size arrays
+// Processors are visited in id order, so ties keep the smaller id first
+#define CPU_SCHEDULE_FIXED(N) \
+static void cpuRankFixed##N(CPUINFO * info, void ** ranked) { \
+    unsigned long long rem[N]; \
+    for (size_t j = 0; j < N; j++) { \
+        void * processor = listGet(info->hProcessors, j); \
+        unsigned long long remTime = processorRemainingTime(processor); \
+        size_t insert = j; \
+        while (insert > 0 && remTime < rem[insert - 1]) { \
+            rem[insert] = rem[insert - 1]; \
+            ranked[insert] = ranked[insert - 1]; \
+            insert--; \
+        } \
+        rem[insert] = remTime; \
+        ranked[insert] = processor; \
+    } \
+} \
+\
+size_t cpuScheduleFast##N(void * hCPU, unsigned long long time) { \
+    INFO(hCPU) \
+    return cpuScheduleFixed(info, time, cpuRankFixed##N); \
+}
+
+CPU_SCHEDULE_FIXED(1)
+CPU_SCHEDULE_FIXED(2)
+CPU_SCHEDULE_FIXED(4)
+
 // compute simulation statistics
-void cpuStats(void * cpuHandle, unsigned int time) {
+void cpuStats(void * cpuHandle, unsigned long long time) {
     INFON(cpuHandle);
 
+    sinkStopThread(info->hSink); // the events are written before the statistics
+    if (info->failed) {
+        return;
+    }
+
+    PROFILE_START(statsStart)
+
     double sumTAT = 0.0;
     double sumOverhead = 0.0;
     double maxOverhead = 0.0;
@@ -573,45 +1403,1472 @@ void cpuStats(void * cpuHandle, unsigned int time) {
     // display results
     printf("Turnaround time %g\n", ceil(sumTAT / (double)count));
     printf("Time overhead %g %g\n", roundf(maxOverhead * 100.0) / 100.0, roundf(sumOverhead * 100.0 / (double)count) / 100.0);
-    printf("Makespan %d\n", time);
-}
+    printf("Makespan %llu\n", time);
+
+    // distance to the best lower bound, whatever the scheduler
+    // the gap is signed: a makespan under its lower bound shows a bug instead of a zero gap
+    if (info->reportBound) {
+        unsigned long long bound = cpuMakespanBound(info);
+        double gap = (double)time - (double)bound;
+        printf("Makespan bound %llu %g%%\n", bound, bound ? round(gap * 10000.0 / (double)bound) / 100.0 : 0.0);
+    }
 
-// helper function definitions
-// Loads processes from the file defined in cpuInfo
-// Returns the pointer to the null-terminated array of processes if successful.
-// Returns NULL otherwise
-static void loadProcesses(CPUINFO * cpuInfo) {
-    INFON(cpuInfo)
+    // use of the cpus with I/O bursts
+    if (info->hasPhases) {
+        unsigned long long busy = 0, overlap = 0;
+        for (size_t i = 0; i < info->processors; i++) {
+            void * processor = listGet(info->hProcessors, i);
+            busy += processorBusyTime(processor);
+            overlap += processorOverlapTime(processor);
+        }
+        printf("CPU utilisation %g%%\n", time ? roundf((double)busy * 10000.0 / ((double)time * info->processors)) / 100.0 : 0.0);
+        printf("I/O overlap %llu\n", overlap);
+    }
 
-    info->hProcs = listCreate();
+    // delays caused by the memory capacity, apart from the delays in the cpu queues
+    if (info->hMemory) {
+        double sumQueueing = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            hProc = listGet(info->hProcs, i);
+
+            unsigned long long service = 0;
+            void * hSubProcs = procSubsHandle(hProc);
+            size_t subs = listCount(hSubProcs);
+            for (size_t j = 0; j < subs; j++) {
+                unsigned long long exec = subProcExecTime(listGet(hSubProcs, j));
+                service = exec > service ? exec : service;
+            }
+            sumQueueing += (double)procTAT(hProc) - (double)service;
+        }
+        sumQueueing -= (double)info->admissionDelay;
 
-    if (!info->hProcs) {
-        return;
+        printf("Memory admission delay %g %u\n", roundf((double)info->admissionDelay * 100.0 / (double)count) / 100.0,
+               info->admissionDelayed);
+        printf("CPU queueing delay %g\n", roundf(sumQueueing * 100.0 / (double)count) / 100.0);
     }
 
-    FILE * hFile = fopen(cpuInfo->processListFile, "r");
+    // share of the cpus between the tenants
+    if (info->hasTenants) {
+        cpuTenantStats(info);
+    }
 
-    if (!hFile) {
-        listDelete(info->hProcs);
-        info->hProcs = NULL;
+    // distance to the critical path
+    if (info->hasDependencies || info->criticalPath) {
+        printf("Critical path bound %llu %g\n", info->criticalBound,
+               info->criticalBound ? roundf((double)time * 100.0 / (double)info->criticalBound) / 100.0 : 0.0);
+    }
+
+    // effect of sizing the sub processes by the load of their cpus
+    if (info->unevenSplit) {
+        printf("Predicted split gain %g\n", info->splitProcs ? roundf(info->splitGain * 100.0 / info->splitProcs) / 100.0 : 0.0);
+    }
+
+    // effect of the gang scheduling on the parallel processes
+    if (info->hGang) {
+        double sumParallelTAT = 0.0;
+        size_t parallel = 0;
+        for (size_t i = 0; i < count; i++) {
+            hProc = listGet(info->hProcs, i);
+            if (procSubs(hProc) > 1) {
+                sumParallelTAT += (double)procTAT(hProc);
+                parallel++;
+            }
+        }
+        printf("Parallel turnaround time %g\n", parallel ? ceil(sumParallelTAT / (double)parallel) : 0.0);
+        printf("Gang held time %llu\n", gangHeldTime(info->hGang));
+    }
+
+    // capacity lost to the switch costs
+    if (info->switchCost || info->coldWindow) {
+        unsigned long long lost = 0;
+        for (size_t i = 0; i < info->processors; i++) {
+            void * processor = listGet(info->hProcessors, i);
+            lost += processorSwitchTime(processor) + processorColdTime(processor);
+        }
+        printf("Lost capacity %llu %g%%\n", lost,
+               time ? roundf((double)lost * 10000.0 / ((double)time * info->processors)) / 100.0 : 0.0);
+
+        for (size_t i = 0; i < info->processors; i++) {
+            void * processor = listGet(info->hProcessors, i);
+            printf("cpu=%zu,switches=%u,switch_time=%llu,cold_time=%llu\n", i, processorSwitches(processor),
+                   processorSwitchTime(processor), processorColdTime(processor));
+        }
+    }
+
+    PROFILE_STOP(info->hProfile, PROF_STATS, statsStart)
+}
+
+// check if the run stopped on an invalid process
+int cpuFailed(void * cpuHandle) {
+    INFO(cpuHandle)
+
+    return info->failed != 0;
+}
+
+// add the process of a line to an embedded cpu
+int cpuFeed(void * cpuHandle, const TRACELINE * line) {
+    if (!cpuHandle || !((CPUINFO *)cpuHandle)->embedded) {
+        procDelete(line->hProc);
+        return 0;
+    }
+    CPUINFO * info = (CPUINFO *)cpuHandle;
+
+    if (!cpuCheckLine(info, line)) {
+        procDelete(line->hProc);
+        return 0;
+    }
+
+    return cpuAddLine(info, line, line->hProc);
+}
+
+// get the number of processors
+unsigned int cpuProcessors(void * cpuHandle) {
+    INFO(cpuHandle)
+
+    return info->processors;
+}
+
+// get the first tick from the given one that has work
+// While processes are unfinished, a tick only has no work if every one of them is blocked on I/O: the
+// cpus are idle with nothing pending or left to report, and nothing waits in the queues of the
+// feedback or fair share schedulers, for memory or for its predecessors. The arrivals of an ordered trace come after the
+// arrived ones, those of another trace are found with a scan.
+unsigned long long cpuNextWork(void * cpuHandle, unsigned long long time) {
+    INFO(cpuHandle)
+
+    if (listCount(info->hReleased) > 0 || listCount(info->hCompleted) > 0) {
+        return time;
+    }
+
+    unsigned long long next = ~0ULL;
+    if (info->unfinished > 0) {
+        if (!info->hasPhases || info->hMlfq || info->hFair || info->admissionCount > 0) {
+            return time;
+        }
+
+        for (size_t i = 0; i < info->processors; i++) {
+            void * processor = listGet(info->hProcessors, i);
+            if (processorCurrentSubProc(processor) || listCount(processorPending(processor)) > 0 ||
+                (info->hSegments && info->hSegments[i])) {
+                return time; // a segment that stopped is reported on the next tick
+            }
+
+            unsigned long long wake = processorNextWake(processor);
+            next = wake < next ? wake : next;
+        }
+        if (next == ~0ULL) {
+            return time; // waiting for a predecessor
+        }
+    }
+
+    size_t first = info->arrivalOrdered ? info->nextArrival : 0, count = listCount(info->hProcs);
+    for (size_t i = first; i < count; i++) {
+        unsigned long long arrival = procArrivalTime(listGet(info->hProcs, i));
+        if (arrival < time) {
+            continue; // arrived on a tick that already ran
+        }
+        next = arrival < next ? arrival : next;
+        if (info->arrivalOrdered) {
+            break; // the rest arrive later
+        }
+    }
+    if (info->pipelined && !info->traceDone && next == ~0ULL) {
+        return time; // the next arrival was not read yet
+    }
+
+    return next > time ? next : time;
+}
+
+// get the tick to run after the given one
+// A snapshot is written at the end of its tick, so a due snapshot stops the skip like work does
+unsigned long long cpuNextTick(void * cpuHandle, unsigned long long time) {
+    INFO(cpuHandle)
+
+    if (time == ~0ULL) {
+        return time; // the last tick of the clock
+    }
+
+    unsigned long long next = cpuNextWork(info, time + 1);
+    if (next == ~0ULL) {
+        return time + 1; // nothing left, the run ends on the next tick
+    }
+
+    if (info->snapshotFile) {
+        if (info->checkpointAt > (long long)time && (unsigned long long)info->checkpointAt < next) {
+            next = (unsigned long long)info->checkpointAt;
+        }
+
+        // first later tick whose successor is a multiple of the period
+        unsigned long long period = info->checkpointPeriod;
+        if (period && (time + 1) / period + 1 <= ~0ULL / period) {
+            unsigned long long due = ((time + 1) / period + 1) * period - 1;
+            next = due < next ? due : next;
+        }
+    }
+
+    return next;
+}
+
+// sum up the turnaround of the processes that finished so far
+void cpuSummary(void * cpuHandle, CPUSUMMARY * summary) {
+    memset(summary, 0, sizeof(CPUSUMMARY));
+    INFON(cpuHandle)
+
+    size_t count = listCount(info->hProcs);
+    for (size_t i = 0; i < count; i++) {
+        void * hProc = listGet(info->hProcs, i);
+        if (procOutstanding(hProc) != 0) {
+            continue; // not finished
+        }
+
+        double TAT = (double)procTAT(hProc);
+        double overhead = TAT / (double)procExecTime(hProc);
+
+        summary->finished++;
+        summary->turnaround += TAT;
+        summary->overhead += overhead;
+        if (overhead > summary->maxOverhead) {
+            summary->maxOverhead = overhead;
+        }
+    }
+    summary->processes = count;
+}
+
+// get the time the simulation starts from
+unsigned long long cpuStartTime(void * cpuHandle) {
+    INFO(cpuHandle)
+
+    return info->startTime;
+}
+
+// write a snapshot of the state at the end of the tick if one is due
+void cpuCheckpoint(void * cpuHandle, unsigned long long time) {
+    INFON(cpuHandle)
+
+    if (!info->snapshotFile) {
         return;
     }
 
-    char sBuffer[80];
-    unsigned int arrive, pid, exec;
-    void * hProc = NULL;
+    if (time == info->checkpointAt || (info->checkpointPeriod && (time + 1) % info->checkpointPeriod == 0)) {
+        fflush(stdout); // the snapshot covers every event written so far
+        if (!snapshotSave(info->snapshotFile, time, info->emitted, info->unfinished, info->finished,
+                          info->hProcs, info->hProcessors)) {
+            cpuReport(info, "Failed to write snapshot at time %llu.\n", time);
+        }
+    }
+}
+
+// helper function definitions
+
+// Assigns a sub process of an arriving process to a processor with the shortest remaining time policy
+// The sub process preempts the current one if its execution time is shorter than the current remaining time
+// (ties keep the current sub process running), otherwise it is queued by remaining time and pid
+static int cpuAssignSRT(void * processor, void * hSubProc) {
+    void * hCurrentSubProc = processorCurrentSubProc(processor);
+    unsigned long long exec = subProcRem(hSubProc); // a sub process back from I/O already worked
+
+    // check if the sub process can replace the current sub process in the processor
+    if (hCurrentSubProc && exec < subProcRem(hCurrentSubProc)) {
+        // put the current sub proc to list of pending processes in the first
+        if (!processorEnqueue(processor, 0, hCurrentSubProc) || !processorEnqueue(processor, 0, hSubProc)) {
+            return 0;
+        }
+        processorClearCurrent(processor);
+        return 1;
+    }
+
+    return cpuQueueSRT(processor, hSubProc);
+}
+
+// Sizes the sub processes of a parallel process so that they are predicted to finish together
+// The finish time of a sub process on a cpu follows the shortest remaining time policy: it starts after
+// the current sub process unless it preempts it, and after the pending sub processes that are not longer.
+// The earliest common finish time is found by bisection, then the extra work is taken back from the
+// most loaded cpus (a shorter sub process never finishes later).
+static double cpuSplitUneven(CPUINFO * info, void * hProc, size_t subs) {
+    void * hSubProcs = procSubsHandle(hProc);
+    unsigned long long even = subProcExecTime(listGet(hSubProcs, 0));
+    unsigned long long total = procExecTime(hProc) + subs; // work plus one tick of synchronisation each
+
+    // queue profile of each cpu: the current remaining time, then the prefix maximum and the
+    // prefix sum of the remaining times of the pending sub processes in queue order
+    size_t segCount = 0;
+    for (size_t j = 0; j < subs; j++) {
+        segCount += listCount(processorPending(listGet(info->hProcessors, info->ranked[j]))) + 1;
+    }
+
+    SPLITSEG * segs = (SPLITSEG *)malloc(segCount * sizeof(SPLITSEG));
+    size_t * first = (size_t *)malloc((subs + 1) * sizeof(size_t));
+    unsigned long long * current = (unsigned long long *)malloc(subs * sizeof(unsigned long long));
+    unsigned long long * sizes = (unsigned long long *)malloc(subs * sizeof(unsigned long long));
+    if (!segs || !first || !current || !sizes) {
+        free(segs);
+        free(first);
+        free(current);
+        free(sizes);
+        return 0.0; // keep the even split
+    }
+
+    unsigned long long evenFinish = 0;
+    size_t seg = 0;
+    for (size_t j = 0; j < subs; j++) {
+        void * processor = listGet(info->hProcessors, info->ranked[j]);
+        void * pending = processorPending(processor);
+        void * hCurrentSubProc = processorCurrentSubProc(processor);
+        size_t count = listCount(pending);
+
+        current[j] = hCurrentSubProc ? subProcRem(hCurrentSubProc) : 0;
+        first[j] = seg;
+        segs[seg].max = 0;
+        segs[seg].before = 0;
+        for (size_t i = 0; i < count; i++, seg++) {
+            unsigned long long rem = subProcRem(listGet(pending, i));
+            segs[seg + 1].max = rem > segs[seg].max ? rem : segs[seg].max;
+            segs[seg + 1].before = segs[seg].before + rem;
+        }
+        seg++;
+
+        unsigned long long finish = cpuSplitFinish(segs + first[j], count, current[j], even);
+        if (finish > evenFinish) {
+            evenFinish = finish;
+        }
+    }
+    first[subs] = seg;
+
+    // earliest finish time at which the cpus can take all the work (the even split fits at evenFinish)
+    unsigned long long lo = 0, hi = evenFinish;
+    while (lo < hi) {
+        unsigned long long mid = lo + (hi - lo) / 2, fits = 0;
+        for (size_t j = 0; j < subs && fits < total; j++) {
+            unsigned long long size = cpuSplitLargest(segs + first[j], first[j + 1] - first[j] - 1, current[j], mid);
+            fits += size > 2 ? size : 2;
+        }
+        if (fits >= total) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    unsigned long long assigned = 0;
+    for (size_t j = 0; j < subs; j++) {
+        sizes[j] = cpuSplitLargest(segs + first[j], first[j + 1] - first[j] - 1, current[j], lo);
+        if (sizes[j] < 2) {
+            sizes[j] = 2; // at least one tick of work and one to synchronise
+        }
+        assigned += sizes[j];
+    }
+
+    // give back the extra work, from the most loaded cpu
+    for (size_t j = subs; j > 0 && assigned > total; j--) {
+        unsigned long long excess = assigned - total;
+        unsigned long long spare = sizes[j - 1] - 2;
+        unsigned long long cut = excess < spare ? excess : spare;
+        sizes[j - 1] -= cut;
+        assigned -= cut;
+    }
+
+    unsigned long long unevenFinish = 0;
+    for (size_t j = 0; j < subs; j++) {
+        subProcResize(listGet(hSubProcs, j), sizes[j]);
+
+        unsigned long long finish = cpuSplitFinish(segs + first[j], first[j + 1] - first[j] - 1, current[j], sizes[j]);
+        if (finish > unevenFinish) {
+            unevenFinish = finish;
+        }
+    }
+
+    free(segs);
+    free(first);
+    free(current);
+    free(sizes);
+
+    return (double)evenFinish - (double)unevenFinish;
+}
+
+// Predicts the ticks a new sub process of the given size needs to finish on a cpu
+static unsigned long long cpuSplitFinish(const SPLITSEG * segs, size_t count, unsigned long long current, unsigned long long size) {
+    if (size < current) {
+        return size; // preempts the current sub process
+    }
+
+    // the sub process is queued after the pending ones that are not longer
+    size_t pos = 0;
+    while (pos < count && segs[pos + 1].max <= size) {
+        pos++;
+    }
+
+    return current + segs[pos].before + size;
+}
+
+// Finds the largest sub process that finishes within the given ticks on a cpu
+static unsigned long long cpuSplitLargest(const SPLITSEG * segs, size_t count, unsigned long long current, unsigned long long ticks) {
+    unsigned long long best = 0;
+
+    if (current > 0) {
+        best = ticks < current - 1 ? ticks : current - 1; // sizes that preempt the current sub process
+    }
+
+    // a size between the prefix maxima of pos and pos + 1 pending sub processes is queued at pos
+    for (size_t pos = 0; pos <= count; pos++) {
+        unsigned long long lo = segs[pos].max > current ? segs[pos].max : current;
+        if (current + segs[pos].before > ticks || ticks - current - segs[pos].before < lo) {
+            break; // the later positions start later and take larger sizes
+        }
+
+        unsigned long long size = ticks - current - segs[pos].before;
+        if (pos < count && size >= segs[pos + 1].max) {
+            if (segs[pos + 1].max <= lo) {
+                continue; // no size is queued at this position
+            }
+            size = segs[pos + 1].max - 1;
+        }
+
+        if (size > best) {
+            best = size;
+        }
+    }
+
+    return best;
+}
+
+// Assigns a sub process of an arriving process to a processor, critical path first
+static int cpuAssignCP(void * processor, void * hSubProc) {
+    void * pending = processorPending(processor);
+    void * hCurrentSubProc = processorCurrentSubProc(processor);
+    unsigned long long priority = procPriority(subProcParent(hSubProc));
+    unsigned long long exec = subProcRem(hSubProc);
+
+    // check if the sub process can replace the current sub process in the processor
+    if (hCurrentSubProc && subProcRem(hCurrentSubProc) > 0 && priority > procPriority(subProcParent(hCurrentSubProc))) {
+        if (!processorEnqueue(processor, 0, hCurrentSubProc) || !processorEnqueue(processor, 0, hSubProc)) {
+            return 0;
+        }
+        processorClearCurrent(processor);
+        return 1;
+    }
+
+    size_t count = listCount(pending), insert = 0;
+    for (insert = 0; insert < count; insert++) {
+        void * hPendingSubProc = listGet(pending, insert);
+        unsigned long long pendingPriority = procPriority(subProcParent(hPendingSubProc));
+        unsigned long long rem = subProcRem(hPendingSubProc);
+
+        if (priority > pendingPriority) {
+            break;
+        } else if (priority == pendingPriority) {
+            if (exec < rem || (exec == rem && procID(subProcParent(hSubProc)) < procID(subProcParent(hPendingSubProc)))) {
+                break;
+            }
+        }
+    }
+
+    return processorEnqueue(processor, insert, hSubProc) != 0;
+}
+
+// Queues a sub process by remaining time and pid, without preempting the current one
+static int cpuQueueSRT(void * processor, void * hSubProc) {
+    void * pending = processorPending(processor);
+    unsigned long long exec = subProcRem(hSubProc);
+
+    // insert the sub proc to pending
+    size_t count = listCount(pending), insert = 0;
+    for (insert = 0; insert < count; insert++) {
+        void * hPendingSubProc = listGet(pending, insert);
+        unsigned long long rem = subProcRem(hPendingSubProc);
+
+        if (exec < rem) {
+            break;
+        } else if (exec == rem) {
+            if (procID(subProcParent(hSubProc)) < procID(subProcParent(hPendingSubProc))) {
+                break;
+            }
+        }
+    }
+
+    return processorEnqueue(processor, insert, hSubProc) != 0;
+}
+
+// Collects the processes arriving at the given time, sorted from shortest to longest execution
+// The batch is gathered first and sorted once on a packed (exec, pid) key
+static size_t cpuArrivals(CPUINFO * info, unsigned long long time) {
+    if (info->pipelined && !info->traceDone && !cpuPull(info, time)) {
+        info->failed = 1;
+    }
+
+    size_t count = listCount(info->hProcs), arriving = 0;
+    size_t first = 0, last = count;
+
+    if (info->arrivalOrdered) {
+        // skip the processes that arrived before (e.g. before a resumed snapshot)
+        while (info->nextArrival < count && procArrivalTime(listGet(info->hProcs, info->nextArrival)) < time) {
+            info->nextArrival++;
+        }
+        first = info->nextArrival;
+    }
+
+    for (size_t i = first; i < last; i++) {
+        void * hProc = listGet(info->hProcs, i);
+
+        if (procArrivalTime(hProc) != time) {
+            if (info->arrivalOrdered) {
+                break; // the rest arrive later
+            }
+            continue; // skip processes not arriving
+        }
+
+        if (arriving == info->arrivalsSize && !cpuGrowArrivals(info)) {
+            break;
+        }
+
+        info->hArrivals[arriving++] = hProc;
+    }
+
+    if (info->arrivalOrdered) {
+        info->nextArrival = first + arriving;
+    }
+
+    // processes whose last predecessor finished after they arrived
+    size_t released = listCount(info->hReleased);
+    for (size_t i = 0; i < released; i++) {
+        if (arriving == info->arrivalsSize && !cpuGrowArrivals(info)) {
+            break;
+        }
+        info->hArrivals[arriving++] = listGet(info->hReleased, i);
+    }
+    listClear(info->hReleased);
+
+    // drop the processes still waiting for a predecessor and pack the sort keys
+    size_t kept = 0;
+    int wide = 0;
+    for (size_t i = 0; i < arriving; i++) {
+        void * hProc = info->hArrivals[i];
+        if (procBlockers(hProc) > 0) {
+            continue; // released by its last predecessor
+        }
+
+        unsigned long long span = info->criticalPath ? procPriority(hProc) : subProcExecTime(listGet(procSubsHandle(hProc), 0));
+        wide |= span > 0xffffffffULL;
+
+        info->arrivalKeys[kept] = (cpuArrivalRank(info, hProc, 0) << 32) | procID(hProc);
+        info->hArrivals[kept] = hProc;
+        kept++;
+
+        if (info->tenantActive[procTenant(hProc)]++ == 0) {
+            info->activeTenants++;
+        }
+    }
+    arriving = kept;
+
+    if (wide) {
+        // a rank does not fit next to the pid: sort by pid, then by rank (the sort keeps the order of equal keys)
+        for (size_t i = 0; i < arriving; i++) {
+            info->arrivalKeys[i] = procID(info->hArrivals[i]);
+        }
+        radixSort(info->arrivalKeys, info->hArrivals, arriving, info->arrivalKeyScratch, info->hArrivalScratch);
+
+        for (size_t i = 0; i < arriving; i++) {
+            info->arrivalKeys[i] = cpuArrivalRank(info, info->hArrivals[i], 1);
+        }
+    }
+
+    radixSort(info->arrivalKeys, info->hArrivals, arriving, info->arrivalKeyScratch, info->hArrivalScratch);
+
+    return arriving;
+}
+
+// Gets the sort rank of an arriving process
+static unsigned long long cpuArrivalRank(CPUINFO * info, void * hProc, int wide) {
+    if (info->criticalPath) {
+        // longest critical path first
+        return (wide ? ~0ULL : 0xffffffffULL) - procPriority(hProc);
+    }
+
+    return subProcExecTime(listGet(procSubsHandle(hProc), 0));
+}
+
+// Doubles the capacity of the arrival scratch arrays
+static int cpuGrowArrivals(CPUINFO * info) {
+    size_t size = info->arrivalsSize ? info->arrivalsSize * 2 : 16;
+
+    void ** hArrivals = (void **)realloc(info->hArrivals, size * sizeof(void *));
+    if (hArrivals) {
+        info->hArrivals = hArrivals;
+    }
+    void ** hArrivalScratch = (void **)realloc(info->hArrivalScratch, size * sizeof(void *));
+    if (hArrivalScratch) {
+        info->hArrivalScratch = hArrivalScratch;
+    }
+    unsigned long long * arrivalKeys = (unsigned long long *)realloc(info->arrivalKeys, size * sizeof(unsigned long long));
+    if (arrivalKeys) {
+        info->arrivalKeys = arrivalKeys;
+    }
+    unsigned long long * arrivalKeyScratch = (unsigned long long *)realloc(info->arrivalKeyScratch, size * sizeof(unsigned long long));
+    if (arrivalKeyScratch) {
+        info->arrivalKeyScratch = arrivalKeyScratch;
+    }
+
+    if (!hArrivals || !hArrivalScratch || !arrivalKeys || !arrivalKeyScratch) {
+        return 0;
+    }
+
+    info->arrivalsSize = size;
+    return 1;
+}
+
+// Schedules the arriving processes using a ranking specialised for a fixed number of processors
+static size_t cpuScheduleFixed(CPUINFO * info, unsigned long long time, void (*rank)(CPUINFO *, void **)) {
+    PROFILE_START(arrivalStart)
+    size_t arriving = cpuArrivals(info, time);
+    PROFILE_STOP(info->hProfile, PROF_ARRIVALS, arrivalStart)
+
+    void * ranked[4];
+
+    for (size_t i = 0; i < arriving; i++) {
+        void * hProc = info->hArrivals[i];
+
+        PROFILE_START(rankStart)
+        rank(info, ranked);
+        PROFILE_STOP(info->hProfile, PROF_RANKING, rankStart)
+
+        PROFILE_START(pendingStart)
+        size_t subs = procSubs(hProc);
+        for (size_t j = 0; j < subs; j++) {
+            if (!cpuAssignSRT(ranked[j], listGet(procSubsHandle(hProc), j))) {
+                return i;
+            }
+        }
+        PROFILE_STOP(info->hProfile, PROF_PENDING, pendingStart)
+    }
+
+    return arriving;
+}
+
+// Copies an argument string
+static char * copyArgument(const char * argument) {
+    char * copy = (char *)calloc(strlen(argument) + 1, sizeof(char));
+
+    if (copy) {
+        strcpy(copy, argument);
+    }
+
+    return copy;
+}
+
+// Reads a number from 0 to max without a sign
+static int readNumber(const char * argument, unsigned long long max, unsigned long long * pValue, const char ** psEnd) {
+    if (!isdigit((unsigned char)*argument)) {
+        return 0; // strtoull would take a sign or blanks
+    }
+
+    char * sEnd = NULL;
+    errno = 0;
+    unsigned long long value = strtoull(argument, &sEnd, 10);
+    if (errno == ERANGE || value > max || (!psEnd && *sEnd)) {
+        return 0;
+    }
+
+    *pValue = value;
+    if (psEnd) {
+        *psEnd = sEnd;
+    }
+    return 1;
+}
+
+// Writes the first bytes of a recorded output to stdout
+static int copyOutputPrefix(const char * fileName, unsigned long long bytes) {
+    FILE * hFile = fopen(fileName, "rb");
+
+    if (!hFile) {
+        return 0;
+    }
+
+    char sBuffer[65536];
+    while (bytes > 0) {
+        size_t chunk = bytes < sizeof(sBuffer) ? (size_t)bytes : sizeof(sBuffer);
+        if (fread(sBuffer, 1, chunk, hFile) != chunk) {
+            break; // the recorded output is shorter than the snapshot claims
+        }
+        fwrite(sBuffer, 1, chunk, stdout);
+        bytes -= chunk;
+    }
+
+    fclose(hFile);
+
+    return bytes == 0;
+}
+// Loads processes from the file defined in cpuInfo
+// Each line holds the arrival time, pid, execution time and p (parallelisable) or n,
+// optionally followed by key=value columns:
+//   after=<pid>,<pid>,...  the process is released once these processes finished
+//   phases=<cpu>,<io>,<cpu>,...  alternating cpu and I/O bursts (replaces the execution time,
+//                                the process runs as a single sub process)
+//   mem=<units>  memory demand of the process, split evenly by its sub processes (used with -M)
+//   tenant=<name>  tenant owning the process ("default" if none)
+//   weight=<w>  fair share weight of the tenant (1 unless given)
+// The lines are parsed by info->loadThreads threads (see trace.h) and added in file order.
+// A gzip or zstd compressed trace is decompressed while it is parsed (see stream.h).
+// Sets cpuInfo->hProcs to NULL if failed
+static void loadProcesses(CPUINFO * cpuInfo) {
+    INFON(cpuInfo)
+
+    info->hProcs = listCreate();
+
+    if (!info->hProcs) {
+        return;
+    }
+
+    void * hStream = cpuOpenTrace(info);
+
+    if (!hStream) {
+        listDelete(info->hProcs);
+        info->hProcs = NULL;
+        return;
+    }
+
+    LOADSTATE load = { info, NULL, 0, 0 };
+    int failed = !traceRead(streamFile(hStream), info->loadThreads, info->processors, cpuLoadChunk, &load);
+
+    // close the file after reading
+    if (!streamClose(hStream) && !failed) {
+        cpuReport(cpuInfo, "%s is corrupt or cut short.\n", cpuInfo->processListFile);
+        failed = 1;
+    }
+
+    if (!failed && load.depCount > 0) {
+        failed = !linkDependencies(info, load.deps, load.depCount);
+        info->hasDependencies = !failed;
+    }
+    free(load.deps);
+
+    if (failed) {
+        size_t count = listCount(info->hProcs);
+        for (size_t i = 0; i < count; i++) {
+            procDelete(listGet(info->hProcs, i));
+        }
+        listDelete(info->hProcs);
+        info->hProcs = NULL;
+    }
+}
+
+// Adds the processes of a chunk of the trace, in order
+static int cpuLoadChunk(void * context, void * hChunk) {
+    LOADSTATE * load = (LOADSTATE *)context;
+    CPUINFO * info = load->info;
+    size_t count = traceCount(hChunk);
+
+    for (size_t i = 0; i < count; i++) {
+        TRACELINE line;
+        traceLine(hChunk, i, &line);
+
+        void * hProc = traceTake(hChunk, i);
+        if (!cpuAddLine(info, &line, hProc)) {
+            return 0;
+        }
+
+        for (unsigned int j = 0; j < line.afterCount; j++) {
+            if (load->depCount == load->depSize) {
+                load->depSize = load->depSize ? load->depSize * 2 : 64;
+                DEPENDENCY * grown = (DEPENDENCY *)realloc(load->deps, load->depSize * sizeof(DEPENDENCY));
+                if (!grown) {
+                    return 0;
+                }
+                load->deps = grown;
+            }
+            load->deps[load->depCount].hProc = hProc;
+            load->deps[load->depCount].pid = line.after[j];
+            load->depCount++;
+        }
+    }
+
+    return 1;
+}
+
+// Reports an error message to the error hook of an embedded cpu, or to stderr
+static void cpuReport(CPUINFO * info, const char * format, ...) {
+    va_list args;
+    va_start(args, format);
+
+    if (info->embedded) {
+        char sMessage[CPU_MESSAGE];
+        int length = vsnprintf(sMessage, sizeof(sMessage), format, args);
+        if (length > 0 && (size_t)length < sizeof(sMessage) && sMessage[length - 1] == '\n') {
+            sMessage[length - 1] = '\0'; // the hook gets the message without its line break
+        }
+        info->hooks.error(info->hooks.context, sMessage);
+    } else {
+        vfprintf(stderr, format, args);
+    }
+
+    va_end(args);
+}
+
+// Checks the process of a line added while the simulation runs
+// The simulation only knows the processes added so far, so they must come in order of arrival
+static int cpuCheckLine(CPUINFO * info, const TRACELINE * line) {
+    void * hProc = line->hProc;
+    size_t count = listCount(info->hProcs);
+
+    if (count > 0 && procArrivalTime(hProc) < procArrivalTime(listGet(info->hProcs, count - 1))) {
+        if (info->embedded) {
+            cpuReport(info, "Process %u arrives before the process fed before it.\n", line->pid);
+        } else {
+            cpuReport(info, "Process %u arrives before the process above it, pipelined runs (-P) need a trace sorted by arrival time.\n", line->pid);
+        }
+    } else if (line->afterCount > 0) {
+        cpuReport(info, "Process %u has an after= column, which pipelined runs (-P) cannot resolve.\n", line->pid);
+    } else if (line->phaseCount > 0 && info->useOwnScheduler) {
+        cpuReport(info, "I/O bursts (phases=) cannot be combined with -c.\n");
+    } else if (info->hMemory && !mempoolFitsEmpty(info->hMemory, cpuSubMemory(hProc), procSubs(hProc))) {
+        cpuReport(info, "Process %u needs more memory than the cpus have.\n", line->pid);
+    } else {
+        return 1;
+    }
+
+    return 0;
+}
+
+// Adds the process of a line of the trace to info->hProcs, with its tenant
+static int cpuAddLine(CPUINFO * info, const TRACELINE * line, void * hProc) {
+    if (!listPush(info->hProcs, hProc)) {
+        procDelete(hProc);
+        return 0;
+    }
+
+    if (line->phaseCount > 0) {
+        info->hasPhases = 1;
+    }
+
+    unsigned int tenant = 0;
+    if (line->tenant) {
+        info->hasTenants = 1;
+    }
+    if (!cpuTenant(info, line->tenant ? line->tenant : "default", &tenant)) {
+        return 0;
+    }
+    procSetTenant(hProc, tenant);
+
+    // cheap makespan bounds, the one of the release times is computed at the end (cpuMakespanBound)
+    unsigned long long work = procWork(hProc);
+    unsigned long long subs = procSubs(hProc) ? procSubs(hProc) : 1;
+    // the sums saturate instead of wrapping around, so a bound is never below the true makespan
+    unsigned long long span = work / subs + (work % subs != 0);
+    unsigned long long finish = span > ~0ULL - procArrivalTime(hProc) ? ~0ULL : procArrivalTime(hProc) + span;
+    info->totalWork = work > ~0ULL - info->totalWork ? ~0ULL : info->totalWork + work;
+    info->longestBound = finish > info->longestBound ? finish : info->longestBound;
+
+    int failed = 0;
+    if (finish == ~0ULL) {
+        cpuReport(info, "Process %u cannot finish before the clock runs out.\n", line->pid);
+        failed = 1;
+    }
+    if (line->hasWeight) {
+        if (line->weight == 0) {
+            cpuReport(info, "Process %u has a zero weight.\n", line->pid);
+            failed = 1;
+        }
+        info->tenantWeights[tenant] = (unsigned int)line->weight;
+    }
+
+    if (line->badBursts) {
+        cpuReport(info, "Process %u has no bursts, an empty burst or ends with an I/O burst.\n", line->pid);
+        failed = 1;
+    }
+
+    return !failed;
+}
+
+// Opens the trace, with a hint if the build cannot decompress it
+static void * cpuOpenTrace(CPUINFO * info) {
+    STREAMFORMAT format = STREAM_PLAIN;
+    void * hStream = streamOpen(info->processListFile, &format);
+
+    if (!hStream && !streamSupports(format)) {
+        cpuReport(info, "%s is %s compressed, build with make %s=1 to read it.\n", info->processListFile,
+                format == STREAM_GZIP ? "gzip" : "zstd", format == STREAM_GZIP ? "ZLIB" : "ZSTD");
+    }
+
+    return hStream;
+}
+
+// Starts the parser thread of a pipelined run
+// The parser hands the processes over in trace order through a ring, the simulation takes them
+// when it reaches their arrival time (see cpuPull)
+static void cpuStartParser(CPUINFO * info) {
+    info->hProcs = listCreate();
+    info->hStream = cpuOpenTrace(info);
+    info->hTraceRing = ringCreate(sizeof(PIPEREC), CPU_TRACE_RING);
+
+    if (info->hProcs && info->hStream && info->hTraceRing) {
+        info->parserStarted = pthread_create(&info->parser, NULL, cpuParse, info) == 0;
+    }
+
+    if (!info->parserStarted) {
+        listDelete(info->hProcs);
+        info->hProcs = NULL;
+        streamClose(info->hStream);
+        info->hStream = NULL;
+    }
+}
+
+// Stops the parser thread and deletes the processes it parsed that were not taken
+static void cpuStopParser(CPUINFO * info) {
+    if (info->parserStarted) {
+        ringClose(info->hTraceRing); // the parser stops at its next line
+        pthread_join(info->parser, NULL);
+        info->parserStarted = 0;
+    }
+
+    PIPEREC rec;
+    while (ringPop(info->hTraceRing, &rec)) {
+        procDelete(rec.line.hProc);
+        free((char *)rec.line.tenant);
+    }
+    ringDelete(info->hTraceRing);
+    info->hTraceRing = NULL;
+}
 
-    while (fscanf(hFile, "%u %u %u %s\n", &arrive, &pid, &exec, sBuffer) != EOF) {
-        hProc = procCreate(arrive, pid, exec, strcmp(sBuffer, "p") == 0, info->processors);
+// Parses the trace into info->hTraceRing
+static void * cpuParse(void * hInfo) {
+    CPUINFO * info = (CPUINFO *)hInfo;
+    PIPEREC rec;
+    memset(&rec, 0, sizeof(rec));
 
-        if (!listPush(info->hProcs, hProc)) {
-            listDelete(info->hProcs);
+    rec.failed = !traceRead(streamFile(info->hStream), info->loadThreads, info->processors, cpuPipeChunk, info);
+    if (!streamClose(info->hStream) && !rec.failed) {
+        cpuReport(info, "%s is corrupt or cut short.\n", info->processListFile);
+        rec.failed = 1;
+    }
+    info->hStream = NULL;
+
+    ringPushWait(info->hTraceRing, &rec); // the end of the trace
+
+    return NULL;
+}
+
+// Hands the lines of a chunk over to the simulation
+static int cpuPipeChunk(void * context, void * hChunk) {
+    CPUINFO * info = (CPUINFO *)context;
+    size_t count = traceCount(hChunk);
+
+    for (size_t i = 0; i < count; i++) {
+        PIPEREC rec;
+        memset(&rec, 0, sizeof(rec));
+        traceLine(hChunk, i, &rec.line);
+
+        // the chunk is reused once this returns
+        rec.line.after = NULL;
+        if (rec.line.tenant) {
+            rec.line.tenant = copyArgument(rec.line.tenant);
+            if (!rec.line.tenant) {
+                return 0;
+            }
+        }
+
+        rec.line.hProc = traceTake(hChunk, i);
+        if (!ringPushWait(info->hTraceRing, &rec)) {
+            procDelete(rec.line.hProc);
+            free((char *)rec.line.tenant);
+            return 0; // the simulation stopped
+        }
+    }
+
+    return 1;
+}
+
+// Takes the processes parsed so far until one arrives after the given time
+// The processes arrive in trace order, so every process arriving by then is known once a later one is taken
+static int cpuPull(CPUINFO * info, unsigned long long time) {
+    size_t count = listCount(info->hProcs);
+
+    while (count == 0 || procArrivalTime(listGet(info->hProcs, count - 1)) <= time) {
+        PIPEREC rec;
+        memset(&rec, 0, sizeof(rec));
+        if (!ringPopWait(info->hTraceRing, &rec) || !rec.line.hProc) {
+            info->traceDone = 1;
+            if (rec.failed) {
+                cpuReport(info, "Failed to read the processes of %s.\n", info->processListFile);
+            }
+            return !rec.failed;
+        }
+
+        void * hProc = rec.line.hProc;
+        int valid = cpuCheckLine(info, &rec.line);
+        if (!valid) {
             procDelete(hProc);
-            info->hProcs = NULL;
-            return;
         }
+        int added = valid && cpuAddLine(info, &rec.line, hProc);
+        free((char *)rec.line.tenant);
+
+        if (!added) {
+            info->traceDone = 1;
+            return 0;
+        }
+        count++;
+    }
+
+    return 1;
+}
+
+// Links the dependencies read from the trace to the processes
+static int linkDependencies(CPUINFO * info, DEPENDENCY * deps, size_t count) {
+    size_t procCount = listCount(info->hProcs);
+    PROCREF * refs = (PROCREF *)malloc((procCount + 1) * sizeof(PROCREF));
+    if (!refs) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < procCount; i++) {
+        refs[i].hProc = listGet(info->hProcs, i);
+        refs[i].key = procID(refs[i].hProc);
+    }
+    qsort(refs, procCount, sizeof(PROCREF), procRefCompare);
+
+    int linked = 1;
+    for (size_t i = 0; i < count && linked; i++) {
+        PROCREF key = { NULL, deps[i].pid, 0 };
+        PROCREF * found = (PROCREF *)bsearch(&key, refs, procCount, sizeof(PROCREF), procRefCompare);
+        if (!found) {
+            cpuReport(info, "Process %u depends on unknown process %u.\n", procID(deps[i].hProc), deps[i].pid);
+            linked = 0;
+        } else if (!procDepend(deps[i].hProc, found->hProc)) {
+            cpuReport(info, "Process %u cannot depend on process %u.\n", procID(deps[i].hProc), deps[i].pid);
+            linked = 0;
+        }
+    }
+
+    free(refs);
+    return linked;
+}
+
+// Compares two process references by key
+static int procRefCompare(const void * a, const void * b) {
+    const PROCREF * refA = (const PROCREF *)a;
+    const PROCREF * refB = (const PROCREF *)b;
+
+    if (refA->key < refB->key) {
+        return -1;
+    }
+    return refA->key > refB->key;
+}
+
+// Compares two process references by tenant, then by key
+static int procRefTenantCompare(const void * a, const void * b) {
+    unsigned int tenantA = procTenant(((const PROCREF *)a)->hProc);
+    unsigned int tenantB = procTenant(((const PROCREF *)b)->hProc);
+
+    if (tenantA != tenantB) {
+        return tenantA < tenantB ? -1 : 1;
+    }
+    return procRefCompare(a, b);
+}
+
+// Computes the critical path of the dependency graph
+static int cpuCriticalPath(CPUINFO * info) {
+    size_t count = listCount(info->hProcs);
+    PROCREF * refs = (PROCREF *)malloc((count + 1) * sizeof(PROCREF));
+    size_t * order = (size_t *)malloc((count + 1) * sizeof(size_t));
+    unsigned int * indegree = (unsigned int *)malloc((count + 1) * sizeof(unsigned int));
+    unsigned long long * start = (unsigned long long *)malloc((count + 1) * sizeof(unsigned long long));
+    if (!refs || !order || !indegree || !start) {
+        free(refs);
+        free(order);
+        free(indegree);
+        free(start);
+        return 0;
+    }
+
+    // successors are looked up by handle
+    for (size_t i = 0; i < count; i++) {
+        refs[i].hProc = listGet(info->hProcs, i);
+        refs[i].key = (unsigned long long)(size_t)refs[i].hProc;
+        refs[i].index = i;
+        indegree[i] = procBlockers(refs[i].hProc);
+        start[i] = procArrivalTime(refs[i].hProc);
+    }
+    qsort(refs, count, sizeof(PROCREF), procRefCompare);
+
+    // topological order (Kahn), in trace order among the ready processes
+    size_t head = 0, tail = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (indegree[i] == 0) {
+            order[tail++] = i;
+        }
+    }
+
+    unsigned long long bound = 0;
+    while (head < tail) {
+        size_t i = order[head++];
+        void * hProc = listGet(info->hProcs, i);
+
+        // earliest finish, with the parallel work spread over all of its sub processes
+        unsigned long long subs = procSubs(hProc);
+        unsigned long long exec = procExecTime(hProc);
+        unsigned long long finish = start[i] + (subs > 1 ? (exec + subs + subs - 1) / subs : exec);
+        if (finish > bound) {
+            bound = finish;
+        }
+
+        void * hSuccessors = procSuccessors(hProc);
+        size_t succCount = listCount(hSuccessors);
+        for (size_t j = 0; j < succCount; j++) {
+            PROCREF key = { NULL, (unsigned long long)(size_t)listGet(hSuccessors, j), 0 };
+            size_t succ = ((PROCREF *)bsearch(&key, refs, count, sizeof(PROCREF), procRefCompare))->index;
+
+            if (finish > start[succ]) {
+                start[succ] = finish;
+            }
+            if (--indegree[succ] == 0) {
+                order[tail++] = succ;
+            }
+        }
+    }
+
+    int acyclic = tail == count;
+
+    // priority of each process: the longest chain of work from its start to the end of the graph
+    for (size_t k = tail; k > 0 && acyclic; k--) {
+        void * hProc = listGet(info->hProcs, order[k - 1]);
+        unsigned long long longest = 0;
+
+        void * hSuccessors = procSuccessors(hProc);
+        size_t succCount = listCount(hSuccessors);
+        for (size_t j = 0; j < succCount; j++) {
+            unsigned long long priority = procPriority(listGet(hSuccessors, j));
+            if (priority > longest) {
+                longest = priority;
+            }
+        }
+
+        procSetPriority(hProc, subProcExecTime(listGet(procSubsHandle(hProc), 0)) + longest);
+    }
+
+    info->criticalBound = bound;
+
+    free(refs);
+    free(order);
+    free(indegree);
+    free(start);
+
+    return acyclic;
+}
+
+// Queues the sub processes whose I/O burst completed again on their processor
+// They follow the policy of the arrivals: they may preempt the current sub process
+static int cpuWake(CPUINFO * info, unsigned long long time) {
+    for (size_t i = 0; i < info->processors; i++) {
+        void * processor = listGet(info->hProcessors, i);
+
+        processorWake(processor, time, info->hWoken);
+
+        size_t count = listCount(info->hWoken);
+        for (size_t j = 0; j < count; j++) {
+            void * hSubProc = listGet(info->hWoken, j);
+            int queued = 0;
+
+            if (info->hMlfq) {
+                queued = mlfqPush(info->hMlfq, (unsigned int)i, hSubProc);
+            } else if (info->hFair) {
+                queued = fairAssign(info->hFair, processor, hSubProc, procTenant(subProcParent(hSubProc)));
+            } else if (info->criticalPath) {
+                queued = cpuAssignCP(processor, hSubProc);
+            } else {
+                queued = cpuAssignSRT(processor, hSubProc);
+            }
+
+            if (!queued) {
+                return 0;
+            }
+        }
+
+        listClear(info->hWoken);
+    }
+
+    return 1;
+}
+
+// Gets the memory demand of each sub process of a process
+// The demand of a parallel process is split evenly, rounded up
+static unsigned long long cpuSubMemory(void * hProc) {
+    unsigned long long subs = procSubs(hProc);
+
+    return subs ? (procMemory(hProc) + subs - 1) / subs : 0;
+}
+
+// Ranks the cpus with room for the memory of a process and reserves it
+static int cpuReserve(CPUINFO * info, void * hProc, unsigned long long time) {
+    size_t subs = procSubs(hProc);
+
+    if (!mempoolPlace(info->hMemory, info->hProcessors, time, cpuSubMemory(hProc), subs, info->ranked)) {
+        return 0;
+    }
+
+    // remember the cpus to release the memory once the process finished
+    void * hSubProcs = procSubsHandle(hProc);
+    for (size_t j = 0; j < subs; j++) {
+        subProcSetCPU(listGet(hSubProcs, j), info->ranked[j]);
+    }
+
+    return 1;
+}
+
+// Places the processes waiting for memory that fit now, in the order they were ready
+// The first waiting process blocks the others, so a large process is not starved by smaller ones;
+// it is only tried again once some memory was released
+static int cpuAdmit(CPUINFO * info, unsigned long long time) {
+    if (!info->memoryFreed) {
+        return 1;
+    }
+    info->memoryFreed = 0;
+
+    while (info->admissionCount > 0) {
+        ADMISSION * first = &info->admission[info->admissionHead];
+        void * hProc = first->hProc;
+
+        if (!cpuReserve(info, hProc, time)) {
+            break;
+        }
+
+        info->admissionDelay += time - first->since;
+        info->admissionHead++;
+        info->admissionCount--;
+
+        if (info->unevenSplit && procSubs(hProc) > 1) {
+            info->splitGain += cpuSplitUneven(info, hProc, procSubs(hProc));
+            info->splitProcs++;
+        }
+
+        if (!cpuPlace(info, hProc)) {
+            return 0;
+        }
+    }
+
+    if (info->admissionCount == 0) {
+        info->admissionHead = 0;
+    }
+
+    return 1;
+}
+
+// Appends a process to the processes waiting for memory
+static int cpuWaitMemory(CPUINFO * info, void * hProc, unsigned long long time) {
+    if (info->admissionHead + info->admissionCount == info->admissionSize) {
+        if (info->admissionHead > 0) {
+            // reuse the space of the admitted processes
+            memmove(info->admission, info->admission + info->admissionHead, info->admissionCount * sizeof(ADMISSION));
+            info->admissionHead = 0;
+        } else {
+            size_t size = info->admissionSize ? info->admissionSize * 2 : 16;
+            ADMISSION * grown = (ADMISSION *)realloc(info->admission, size * sizeof(ADMISSION));
+            if (!grown) {
+                return 0;
+            }
+            info->admission = grown;
+            info->admissionSize = size;
+        }
+    }
+
+    ADMISSION * last = &info->admission[info->admissionHead + info->admissionCount++];
+    last->hProc = hProc;
+    last->since = time;
+    info->admissionDelayed++;
+
+    return 1;
+}
+
+// Queues the sub processes of a process on the ranked cpus
+static int cpuPlace(CPUINFO * info, void * hProc) {
+    size_t subs = procSubs(hProc);
+
+    if (info->hGang && subs > 1) {
+        // a gang waits in the queues until all of its cpus are free
+        for (size_t j = 0; j < subs; j++) {
+            if (!cpuQueueSRT(listGet(info->hProcessors, info->ranked[j]), listGet(procSubsHandle(hProc), j))) {
+                return 0;
+            }
+        }
+        return gangAdd(info->hGang, hProc, info->ranked);
+    }
+
+    for (size_t j = 0; j < subs; j++) {
+        void * processor = listGet(info->hProcessors, info->ranked[j]);
+        void * hSubProc = listGet(procSubsHandle(hProc), j);
+        int queued = 0;
+
+        if (info->hFair) {
+            queued = fairAssign(info->hFair, processor, hSubProc, procTenant(hProc));
+        } else if (info->criticalPath) {
+            queued = cpuAssignCP(processor, hSubProc);
+        } else {
+            queued = cpuAssignSRT(processor, hSubProc);
+        }
+
+        if (!queued) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+// Finds the index of a tenant by name, adding the tenant if it is new
+// Tenants are few, the names are searched from the latest one (traces tend to group them)
+static int cpuTenant(CPUINFO * info, const char * name, unsigned int * pTenant) {
+    for (unsigned int i = info->tenants; i > 0; i--) {
+        if (strcmp(info->tenantNames[i - 1], name) == 0) {
+            *pTenant = i - 1;
+            return 1;
+        }
+    }
+
+    if (info->tenants == info->tenantSize) {
+        unsigned int size = info->tenantSize ? info->tenantSize * 2 : 8;
+        char ** names = (char **)realloc(info->tenantNames, size * sizeof(char *));
+        if (names) {
+            info->tenantNames = names;
+        }
+        unsigned int * weights = (unsigned int *)realloc(info->tenantWeights, size * sizeof(unsigned int));
+        if (weights) {
+            info->tenantWeights = weights;
+        }
+        if (!names || !weights) {
+            return 0;
+        }
+
+        // the activity of the tenants is tracked once the run started (tenants met by a pipelined run)
+        if (info->tenantActive) {
+            unsigned int * active = (unsigned int *)realloc(info->tenantActive, (size + 1) * sizeof(unsigned int));
+            if (active) {
+                info->tenantActive = active;
+            }
+            unsigned long long * contended = (unsigned long long *)realloc(info->tenantContended, (size + 1) * sizeof(unsigned long long));
+            if (contended) {
+                info->tenantContended = contended;
+            }
+            if (!active || !contended) {
+                return 0;
+            }
+            memset(active + info->tenantSize + 1, 0, (size - info->tenantSize) * sizeof(unsigned int));
+            memset(contended + info->tenantSize + 1, 0, (size - info->tenantSize) * sizeof(unsigned long long));
+        }
+        info->tenantSize = size;
+    }
+
+    char * copy = copyArgument(name);
+    if (!copy) {
+        return 0;
+    }
+
+    info->tenantNames[info->tenants] = copy;
+    info->tenantWeights[info->tenants] = 1;
+    *pTenant = info->tenants++;
+
+    return 1;
+}
+
+// Prints the throughput, share of the cpus and turnaround percentiles of each tenant
+// The throughput is in processes per 1000 ticks from the first arrival to the last finish of the
+// tenant, the cpu share counts the ticks where several tenants had unfinished processes
+static void cpuTenantStats(CPUINFO * info) {
+    size_t count = listCount(info->hProcs);
+    PROCREF * refs = (PROCREF *)malloc((count + 1) * sizeof(PROCREF));
+    if (!refs) {
+        return;
+    }
+
+    // group the turnaround times by tenant
+    for (size_t i = 0; i < count; i++) {
+        refs[i].hProc = listGet(info->hProcs, i);
+        refs[i].key = procTAT(refs[i].hProc);
+        refs[i].index = i;
+    }
+    qsort(refs, count, sizeof(PROCREF), procRefTenantCompare);
+
+    unsigned long long totalWeight = 0;
+    for (unsigned int i = 0; i < info->tenants; i++) {
+        totalWeight += info->tenantWeights[i];
+    }
+
+    for (size_t first = 0, last = 0; first < count; first = last) {
+        unsigned int tenant = procTenant(refs[first].hProc);
+        unsigned long long start = procArrivalTime(refs[first].hProc), end = start;
+
+        for (last = first; last < count && procTenant(refs[last].hProc) == tenant; last++) {
+            unsigned long long arrival = procArrivalTime(refs[last].hProc);
+            start = arrival < start ? arrival : start;
+            end = arrival + procTAT(refs[last].hProc) > end ? arrival + procTAT(refs[last].hProc) : end;
+        }
+
+        size_t n = last - first;
+        unsigned long long percentile[3];
+        const unsigned int ranks[3] = { 50, 95, 99 };
+        for (size_t j = 0; j < 3; j++) {
+            size_t rank = (ranks[j] * n + 99) / 100; // nearest rank
+            percentile[j] = refs[first + rank - 1].key;
+        }
+
+        double span = end > start ? (double)(end - start) : 1.0;
+        printf("tenant=%s,weight=%u,processes=%zu,throughput=%g,cpu_share=%g%%,weight_share=%g%%,tat_p50=%llu,tat_p95=%llu,tat_p99=%llu\n",
+               info->tenantNames[tenant], info->tenantWeights[tenant], n,
+               roundf((double)n * 100000.0 / span) / 100.0,
+               info->contended ? roundf((double)info->tenantContended[tenant] * 10000.0 / (double)info->contended) / 100.0 : 0.0,
+               totalWeight ? roundf((double)info->tenantWeights[tenant] * 10000.0 / (double)totalWeight) / 100.0 : 0.0,
+               percentile[0], percentile[1], percentile[2]);
     }
 
-    fclose(hFile); // close the file after reading
+    free(refs);
 }
 
+// Computes the best analytic lower bound of the makespan of the processes loaded
+// The bounds hold for any scheduler, as a cpu works one tick per tick:
+//   the total work spread over all of the cpus
+//   the arrival of a process plus its own duration on as many cpus as it has sub processes
+//   for each release time, the release time plus the work arriving from it on spread over all of the cpus
+//   the critical path bound, with dependencies
+static unsigned long long cpuMakespanBound(CPUINFO * info) {
+    unsigned long long bound = info->totalWork / info->processors + (info->totalWork % info->processors != 0);
+    bound = info->longestBound > bound ? info->longestBound : bound;
+    if (info->hasDependencies || info->criticalPath) {
+        bound = info->criticalBound > bound ? info->criticalBound : bound;
+    }
+
+    size_t count = listCount(info->hProcs);
+    PROCREF * refs = (PROCREF *)malloc((count + 1) * sizeof(PROCREF));
+    if (!refs) {
+        return bound; // the cheap bounds only
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        refs[i].hProc = listGet(info->hProcs, i);
+        refs[i].key = procArrivalTime(refs[i].hProc);
+        refs[i].index = i;
+    }
+    qsort(refs, count, sizeof(PROCREF), procRefCompare);
+
+    // latest release time first, the work arriving from it on grows; the sums saturate
+    unsigned long long work = 0;
+    for (size_t i = count; i > 0; i--) {
+        unsigned long long add = procWork(refs[i - 1].hProc);
+        work = add > ~0ULL - work ? ~0ULL : work + add;
+        unsigned long long span = work / info->processors + (work % info->processors != 0);
+        unsigned long long release = span > ~0ULL - refs[i - 1].key ? ~0ULL : refs[i - 1].key + span;
+        bound = release > bound ? release : bound;
+    }
+
+    free(refs);
+    return bound;
+}
+
+// Releases the successors of a finished process whose predecessors all finished
+// Successors arriving on this tick are collected with the other arrivals
+static void cpuRelease(CPUINFO * info, void * hProc, unsigned long long time) {
+    void * hSuccessors = procSuccessors(hProc);
+    size_t count = listCount(hSuccessors);
+
+    for (size_t i = 0; i < count; i++) {
+        void * hSuccessor = listGet(hSuccessors, i);
+        if (procResolve(hSuccessor) == 0 && procArrivalTime(hSuccessor) < time) {
+            listPush(info->hReleased, hSuccessor);
+        }
+    }
+}
@@ -6,24 +6,84 @@
 #include <stdlib.h>
 #include <string.h>
 #include "process.h"
+#include "profile.h"
+#include "sink.h"
+#include "trace.h"
+
+// Callbacks of a cpu embedded in another program (see scheduler.h)
+typedef struct {
+    void (*event)(void * context, const EVENT * event); // receives the events instead of stdout
+    void (*error)(void * context, const char * message); // receives the error messages instead of stderr
+    void * context;
+} CPUHOOKS;
+
+// Turnaround of the processes of a cpu that finished so far
+typedef struct {
+    size_t processes; // processes added to the cpu
+    size_t finished;
+    double turnaround; // sum of the turnaround times of the finished processes
+    double overhead; // sum of their turnaround over execution times
+    double maxOverhead;
+} CPUSUMMARY;
 
 // initialize a cpu with the arguments
 void * cpuInit(int argc, char** argv);
 
+// initialize a cpu with the arguments, fed by the caller (cpuFeed) instead of a trace
+// (the events and the errors go to the hooks, nothing is written to stdout or stderr)
+void * cpuInitEmbedded(int argc, char ** argv, const CPUHOOKS * hooks);
+
+// add the process of a line to an embedded cpu, it must not arrive before the last process added
+// returns 1 on success
+// returns 0 if the process is invalid or failed (the process is deleted if it was not added)
+int cpuFeed(void * cpuHandle, const TRACELINE * line);
+
+// sum up the turnaround of the processes that finished so far
+void cpuSummary(void * cpuHandle, CPUSUMMARY * summary);
+
+// get the number of processors
+unsigned int cpuProcessors(void * cpuHandle);
+
+// get the first tick from the given one that has work: a process that runs, arrives or wakes up from
+// I/O (the ticks before it run empty and can be skipped), ~0 if every process added finished
+unsigned long long cpuNextWork(void * cpuHandle, unsigned long long time);
+
+// get the tick to run after the given one: the next tick, or a later one if the ticks between have no
+// work and no snapshot due
+unsigned long long cpuNextTick(void * cpuHandle, unsigned long long time);
+
 // run a single frame in the cpu
-int cpuRun(void * cpuHandle, unsigned int time);
+int cpuRun(void * cpuHandle, unsigned long long time);
 
 // delete the cpu
 void cpuDelete(void * cpuHandle);
 
 // compute simulation statistics
-void cpuStats(void * cpuHandle, unsigned int time);
+void cpuStats(void * cpuHandle, unsigned long long time);
+
+// check if the run stopped on an invalid process (pipelined runs check the trace as they read it)
+int cpuFailed(void * cpuHandle);
+
+// get the time the simulation starts from (0, or the tick after a resumed snapshot)
+unsigned long long cpuStartTime(void * cpuHandle);
+
+// write a snapshot of the state at the end of the tick if one is due
+void cpuCheckpoint(void * cpuHandle, unsigned long long time);
 
 // schedule the process to the cores
-size_t cpuSchedule(void * cpuHandle, unsigned int time);
+size_t cpuSchedule(void * cpuHandle, unsigned long long time);
+
+// schedule the process to the cores, specialised for 1, 2 and 4 processors
+// (requires a trace sorted by arrival time)
+size_t cpuScheduleFast1(void * cpuHandle, unsigned long long time);
+size_t cpuScheduleFast2(void * cpuHandle, unsigned long long time);
+size_t cpuScheduleFast4(void * cpuHandle, unsigned long long time);
 
 // schedule the process to the cores using my own algorithm
-size_t cpuOwnSchedule(void * cpuHandle, unsigned int time);
+size_t cpuOwnSchedule(void * cpuHandle, unsigned long long time);
+
+// schedule the process to the cores with multi-level feedback queues (time quanta and aging)
+size_t cpuMlfqSchedule(void * cpuHandle, unsigned long long time);
 
 // run a core
 // returns the number of unfinished processes in the queue
@@ -40,16 +100,60 @@ void * processorCreate(unsigned cpuID);
 void processorDelete(void * hProcessor);
 
 // Performs a single step of the processor
-void processorRun(void * hProcessor, unsigned int time, void * hRunningSubProcs);
+// The parent of a sub process that completes on this step is added to hCompletedProcs
+void processorRun(void * hProcessor, unsigned long long time, void * hRunningSubProcs, void * hCompletedProcs);
 
 // Returns the list of pending processes
 void * processorPending(void * hProcessor);
 
-// Calculates the total remaining time of the pending processes
-unsigned int processorRemainingTime(void * hProcessor);
+// Inserts a sub process to the pending list at the given index
+// Returns the number of pending sub processes after insertion
+// Returns 0 if failed
+size_t processorEnqueue(void * hProcessor, size_t index, void * hSubProc);
+
+// Moves the sub processes whose I/O burst completed by the given time to hWokenSubProcs
+// (a sub process blocks on the processor that ran its cpu burst)
+// Returns the number of woken sub processes
+size_t processorWake(void * hProcessor, unsigned long long time, void * hWokenSubProcs);
+
+// Gets the tick the first blocked sub process wakes up on, ~0 if none is blocked
+unsigned long long processorNextWake(void * hProcessor);
+
+// Gets the ticks a sub process was worked on
+unsigned long long processorBusyTime(void * hProcessor);
+
+// Gets the ticks worked while another sub process of the processor was blocked on I/O
+unsigned long long processorOverlapTime(void * hProcessor);
+
+// Removes the pending sub process at the given index
+// Returns the removed sub process
+// Returns NULL if failed
+void * processorDequeue(void * hProcessor, size_t index);
+
+// Calculates the total remaining time of the pending, current and blocked processes
+unsigned long long processorRemainingTime(void * hProcessor);
+
+// Calculates the total waiting time of the pending sub processes
+unsigned long long processorWaiting(void * hProcessor, unsigned long long time);
+
+// Keeps (hold 1) or lets (hold 0) the processor dispatch a pending sub process when it is idle
+void processorHold(void * hProcessor, unsigned int hold);
+
+// Sets the context switch cost and the cold cache penalty of resuming a descheduled sub process
+// (one tick per coldWindow ticks away, at most coldMax ticks, 0 disables either limit)
+void processorSetCosts(void * hProcessor, unsigned int switchCost, unsigned int coldWindow, unsigned int coldMax);
+
+// Gets the number of context switches
+unsigned int processorSwitches(void * hProcessor);
+
+// Gets the ticks lost to context switches
+unsigned long long processorSwitchTime(void * hProcessor);
+
+// Gets the ticks lost to cold caches
+unsigned long long processorColdTime(void * hProcessor);
 
 // Gets the nearest deadline of the processor
-unsigned int processorDeadline(void * hProcessor);
+unsigned long long processorDeadline(void * hProcessor);
 
 // Get the target
 void * processorCurrentSubProc(void * hProcessor);
@@ -57,6 +161,9 @@ void * processorCurrentSubProc(void * hProcessor);
 // Clear current sub proc
 void processorClearCurrent(void * hProcessor);
 
+// Set current sub proc (used when restoring a snapshot)
+void processorSetCurrent(void * hProcessor, void * hSubProc);
+
 // Get processor id
 unsigned int processorID(void * hProcessor);
 
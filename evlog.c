@@ -0,0 +1,354 @@
+#include "evlog.h"
+
+#define EVLOG_HEADER_WORDS 4
+#define EVLOG_CHUNK_WORDS (3 + 4 * EVLOG_COLUMNS) // chunk header (3 + 2 * EVLOG_COLUMNS in version 1)
+#define EVLOG_EVENT_BYTES (4 * EVLOG_COLUMNS + 8) // bytes of column data of an event (time and value are wide)
+#define EVLOG_MAX_CHUNK_EVENTS (1u << 20) // largest chunk a reader accepts
+
+// Define struct for a writer
+typedef struct {
+    FILE * hFile;
+    unsigned long long * columns[EVLOG_COLUMNS]; // values of the events of the chunk being filled
+    unsigned int count; // events in the chunk
+    unsigned char * buffer; // encoded chunk
+    int failed;
+} EVLOGWRITER;
+
+// Define struct for a reader
+typedef struct {
+    FILE * hFile;
+    unsigned int version; // format of the log
+    unsigned int chunkEvents; // largest chunk of the log
+    unsigned long long * columns[EVLOG_COLUMNS]; // values of the events of the current chunk
+    unsigned int count; // events in the current chunk
+    unsigned int position; // next event of the current chunk
+    unsigned char * buffer; // encoded chunk
+    unsigned long long chunksRead;
+    unsigned long long chunksSkipped;
+} EVLOGREADER;
+
+// Helper functions declaration
+
+// Encodes a little endian word
+static void evlogPut(unsigned char * bytes, unsigned int value);
+
+// Decodes a little endian word
+static unsigned int evlogGet(const unsigned char * bytes);
+
+// Gets the bytes of a value of a column in a log of the given version
+static size_t evlogWidth(unsigned int version, int column);
+
+// Encodes a little endian value of 4 or 8 bytes
+static void evlogPutValue(unsigned char * bytes, unsigned long long value, size_t width);
+
+// Decodes a little endian value of 4 or 8 bytes
+static unsigned long long evlogGetValue(const unsigned char * bytes, size_t width);
+
+// Writes the chunk being filled
+// Returns 1 on success
+// Returns 0 if failed
+static int evlogFlush(EVLOGWRITER * writer);
+
+// Reads the next chunk that may hold events passing the filter
+// Returns 1 if a chunk was read
+// Returns 0 at the end of the log
+static int evlogReadChunk(EVLOGREADER * reader, const EVLOGFILTER * filter);
+
+#define EVW(h) if (!h) { return 0; } EVLOGWRITER * writer = (EVLOGWRITER*)h;
+#define EVR(h) if (!h) { return 0; } EVLOGREADER * reader = (EVLOGREADER*)h;
+#define EVRN(h) if (!h) { return; } EVLOGREADER * reader = (EVLOGREADER*)h;
+
+// WRITER FUNCTIONS
+
+// Creates a writer appending the log to an open file
+void * evlogCreate(FILE * hFile) {
+    EVLOGWRITER * writer = (EVLOGWRITER *)calloc(1, sizeof(EVLOGWRITER));
+    if (!writer) {
+        return NULL;
+    }
+
+    writer->hFile = hFile;
+    int allocated = 1;
+    for (int i = 0; i < EVLOG_COLUMNS; i++) {
+        writer->columns[i] = (unsigned long long *)malloc(EVLOG_CHUNK_EVENTS * sizeof(unsigned long long));
+        allocated = allocated && writer->columns[i];
+    }
+    writer->buffer = (unsigned char *)malloc(EVLOG_CHUNK_WORDS * 4 + EVLOG_EVENT_BYTES * EVLOG_CHUNK_EVENTS);
+
+    unsigned char header[EVLOG_HEADER_WORDS * 4];
+    evlogPut(header, EVLOG_MAGIC);
+    evlogPut(header + 4, EVLOG_VERSION);
+    evlogPut(header + 8, EVLOG_COLUMNS);
+    evlogPut(header + 12, EVLOG_CHUNK_EVENTS);
+
+    if (!allocated || !writer->buffer || fwrite(header, 1, sizeof(header), hFile) != sizeof(header)) {
+        writer->failed = 1;
+        writer->count = 0;
+        evlogFinish(writer);
+        return NULL;
+    }
+
+    return writer;
+}
+
+// Appends an event, writing a chunk once it is full
+int evlogAppend(void * hWriter, const EVENT * event) {
+    EVW(hWriter)
+
+    unsigned int i = writer->count++;
+    writer->columns[EVLOG_TIME][i] = event->time;
+    writer->columns[EVLOG_TYPE][i] = (unsigned long long)event->type;
+    writer->columns[EVLOG_PID][i] = event->pid;
+    writer->columns[EVLOG_SUB][i] = event->sub;
+    writer->columns[EVLOG_CPU][i] = event->cpu;
+    writer->columns[EVLOG_VALUE][i] = event->value;
+
+    if (writer->count == EVLOG_CHUNK_EVENTS) {
+        return evlogFlush(writer);
+    }
+
+    return !writer->failed;
+}
+
+// Writes the last chunk and deletes the writer
+int evlogFinish(void * hWriter) {
+    EVW(hWriter)
+
+    if (writer->count > 0) {
+        evlogFlush(writer);
+    }
+    int written = !writer->failed;
+
+    for (int i = 0; i < EVLOG_COLUMNS; i++) {
+        free(writer->columns[i]);
+    }
+    free(writer->buffer);
+    free(writer);
+
+    return written;
+}
+
+// READER FUNCTIONS
+
+// Opens a log
+void * evlogOpen(const char * fileName) {
+    FILE * hFile = fopen(fileName, "rb");
+    if (!hFile) {
+        return NULL;
+    }
+
+    unsigned char header[EVLOG_HEADER_WORDS * 4];
+    if (fread(header, 1, sizeof(header), hFile) != sizeof(header) || evlogGet(header) != EVLOG_MAGIC ||
+        evlogGet(header + 4) == 0 || evlogGet(header + 4) > EVLOG_VERSION || evlogGet(header + 8) != EVLOG_COLUMNS ||
+        evlogGet(header + 12) == 0 || evlogGet(header + 12) > EVLOG_MAX_CHUNK_EVENTS) {
+        fclose(hFile);
+        return NULL;
+    }
+
+    EVLOGREADER * reader = (EVLOGREADER *)calloc(1, sizeof(EVLOGREADER));
+    if (!reader) {
+        fclose(hFile);
+        return NULL;
+    }
+
+    reader->hFile = hFile;
+    reader->version = evlogGet(header + 4);
+    reader->chunkEvents = evlogGet(header + 12);
+
+    int allocated = 1;
+    for (int i = 0; i < EVLOG_COLUMNS; i++) {
+        reader->columns[i] = (unsigned long long *)malloc(reader->chunkEvents * sizeof(unsigned long long));
+        allocated = allocated && reader->columns[i];
+    }
+    reader->buffer = (unsigned char *)malloc((size_t)EVLOG_EVENT_BYTES * reader->chunkEvents);
+
+    if (!allocated || !reader->buffer) {
+        evlogClose(reader);
+        return NULL;
+    }
+
+    return reader;
+}
+
+// Closes a log
+void evlogClose(void * hReader) {
+    EVRN(hReader)
+
+    for (int i = 0; i < EVLOG_COLUMNS; i++) {
+        free(reader->columns[i]);
+    }
+    free(reader->buffer);
+    fclose(reader->hFile);
+    free(reader);
+}
+
+// Reads the next event of the log that passes the filter
+int evlogNext(void * hReader, const EVLOGFILTER * filter, EVENT * event) {
+    EVR(hReader)
+
+    for (;;) {
+        while (reader->position < reader->count) {
+            unsigned int i = reader->position++;
+            unsigned long long time = reader->columns[EVLOG_TIME][i];
+            unsigned int pid = (unsigned int)reader->columns[EVLOG_PID][i];
+
+            if (filter && (time < filter->timeFrom || time > filter->timeTo || pid < filter->pidFrom || pid > filter->pidTo)) {
+                continue;
+            }
+
+            event->time = time;
+            event->type = (EVENTTYPE)reader->columns[EVLOG_TYPE][i];
+            event->pid = pid;
+            event->sub = (unsigned int)reader->columns[EVLOG_SUB][i];
+            event->cpu = (unsigned int)reader->columns[EVLOG_CPU][i];
+            event->value = reader->columns[EVLOG_VALUE][i];
+            return 1;
+        }
+
+        if (!evlogReadChunk(reader, filter)) {
+            return 0;
+        }
+    }
+}
+
+// Gets the number of chunks read and skipped
+void evlogChunks(void * hReader, unsigned long long * pRead, unsigned long long * pSkipped) {
+    EVRN(hReader)
+
+    *pRead = reader->chunksRead;
+    *pSkipped = reader->chunksSkipped;
+}
+
+// helper function definitions
+
+// Encodes a little endian word
+static void evlogPut(unsigned char * bytes, unsigned int value) {
+    bytes[0] = (unsigned char)value;
+    bytes[1] = (unsigned char)(value >> 8);
+    bytes[2] = (unsigned char)(value >> 16);
+    bytes[3] = (unsigned char)(value >> 24);
+}
+
+// Decodes a little endian word
+static unsigned int evlogGet(const unsigned char * bytes) {
+    return (unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8) | ((unsigned int)bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+// Gets the bytes of a value of a column
+static size_t evlogWidth(unsigned int version, int column) {
+    return version >= 2 && (column == EVLOG_TIME || column == EVLOG_VALUE) ? 8 : 4;
+}
+
+// Encodes a little endian value of 4 or 8 bytes
+static void evlogPutValue(unsigned char * bytes, unsigned long long value, size_t width) {
+    evlogPut(bytes, (unsigned int)value);
+    if (width == 8) {
+        evlogPut(bytes + 4, (unsigned int)(value >> 32));
+    }
+}
+
+// Decodes a little endian value of 4 or 8 bytes
+static unsigned long long evlogGetValue(const unsigned char * bytes, size_t width) {
+    unsigned long long value = evlogGet(bytes);
+    if (width == 8) {
+        value |= (unsigned long long)evlogGet(bytes + 4) << 32;
+    }
+
+    return value;
+}
+
+// Writes the chunk being filled
+static int evlogFlush(EVLOGWRITER * writer) {
+    unsigned int count = writer->count;
+    unsigned char * bytes = writer->buffer;
+
+    evlogPut(bytes, EVLOG_CHUNK_MAGIC);
+    evlogPut(bytes + 4, count);
+    evlogPut(bytes + 8, EVLOG_EVENT_BYTES * count);
+
+    unsigned char * data = bytes + EVLOG_CHUNK_WORDS * 4;
+    for (int c = 0; c < EVLOG_COLUMNS; c++) {
+        const unsigned long long * values = writer->columns[c];
+        unsigned long long min = values[0], max = values[0];
+        size_t width = evlogWidth(EVLOG_VERSION, c);
+
+        for (unsigned int i = 0; i < count; i++) {
+            min = values[i] < min ? values[i] : min;
+            max = values[i] > max ? values[i] : max;
+            evlogPutValue(data, values[i], width);
+            data += width;
+        }
+
+        evlogPutValue(bytes + 12 + 16 * c, min, 8);
+        evlogPutValue(bytes + 20 + 16 * c, max, 8);
+    }
+
+    size_t size = (size_t)(data - bytes);
+    if (fwrite(bytes, 1, size, writer->hFile) != size) {
+        writer->failed = 1;
+    }
+    writer->count = 0;
+
+    return !writer->failed;
+}
+
+// Reads the next chunk that may hold events passing the filter
+static int evlogReadChunk(EVLOGREADER * reader, const EVLOGFILTER * filter) {
+    unsigned char header[EVLOG_CHUNK_WORDS * 4];
+
+    reader->count = 0;
+    reader->position = 0;
+
+    // version 1 chunks have 32 bit minimum and maximum values
+    size_t bound = reader->version >= 2 ? 8 : 4;
+    size_t headerSize = 12 + 2 * bound * EVLOG_COLUMNS;
+    size_t eventBytes = 0;
+    for (int c = 0; c < EVLOG_COLUMNS; c++) {
+        eventBytes += evlogWidth(reader->version, c);
+    }
+
+    while (fread(header, 1, headerSize, reader->hFile) == headerSize) {
+        unsigned int count = evlogGet(header + 4);
+        unsigned int size = evlogGet(header + 8);
+
+        if (evlogGet(header) != EVLOG_CHUNK_MAGIC || count == 0 || count > reader->chunkEvents ||
+            size != eventBytes * count) {
+            return 0; // not a chunk
+        }
+
+        // skip the chunk if no event can pass the filter
+        if (filter) {
+            unsigned long long minTime = evlogGetValue(header + 12 + 2 * bound * EVLOG_TIME, bound);
+            unsigned long long maxTime = evlogGetValue(header + 12 + 2 * bound * EVLOG_TIME + bound, bound);
+            unsigned long long minPid = evlogGetValue(header + 12 + 2 * bound * EVLOG_PID, bound);
+            unsigned long long maxPid = evlogGetValue(header + 12 + 2 * bound * EVLOG_PID + bound, bound);
+
+            if (maxTime < filter->timeFrom || minTime > filter->timeTo || maxPid < filter->pidFrom || minPid > filter->pidTo) {
+                if (fseek(reader->hFile, (long)size, SEEK_CUR) != 0) {
+                    return 0;
+                }
+                reader->chunksSkipped++;
+                continue;
+            }
+        }
+
+        if (fread(reader->buffer, 1, size, reader->hFile) != size) {
+            return 0; // cut short
+        }
+
+        const unsigned char * data = reader->buffer;
+        for (int c = 0; c < EVLOG_COLUMNS; c++) {
+            size_t width = evlogWidth(reader->version, c);
+            for (unsigned int i = 0; i < count; i++) {
+                reader->columns[c][i] = evlogGetValue(data, width);
+                data += width;
+            }
+        }
+
+        reader->count = count;
+        reader->chunksRead++;
+        return 1;
+    }
+
+    return 0;
+}
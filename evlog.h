@@ -0,0 +1,78 @@
+#ifndef EVLOG_H_
+#define EVLOG_H_
+
+// Include dependencies
+#include <stdio.h>
+#include <stdlib.h>
+#include "sink.h"
+
+// Defines the binary event log, a columnar file of the events of a run.
+// All the values are little endian, 32 bit words except the time and value columns and the minimum
+// and maximum values of the chunks, which are 64 bit (version 1 logs, still read, had only 32 bit words).
+//   file header: magic, version, number of columns, events per chunk
+//   chunks: magic, number of events, bytes of column data, then the minimum and maximum value of each
+//           column, then the column data (each column stores the values of the chunk's events in order)
+// The columns are time, type, pid, sub, cpu and value (see EVENT). A reader looks at the minimum and
+// maximum values of a chunk to skip it without reading its data. A chunk cut short at the end of the
+// file (e.g. the writer was killed) ends the log.
+
+#define EVLOG_MAGIC 0x474c5645 // "EVLG"
+#define EVLOG_CHUNK_MAGIC 0x4b4e4843 // "CHNK"
+#define EVLOG_VERSION 2
+#define EVLOG_CHUNK_EVENTS 4096
+
+// Columns of the log
+typedef enum {
+    EVLOG_TIME = 0,
+    EVLOG_TYPE,
+    EVLOG_PID,
+    EVLOG_SUB,
+    EVLOG_CPU,
+    EVLOG_VALUE,
+    EVLOG_COLUMNS
+} EVLOGCOLUMN;
+
+// Events selected by a reader, the ranges are inclusive
+typedef struct {
+    unsigned long long timeFrom;
+    unsigned long long timeTo;
+    unsigned int pidFrom;
+    unsigned int pidTo;
+} EVLOGFILTER;
+
+// WRITER FUNCTIONS
+
+// Creates a writer appending the log to an open file, starting with the file header
+// Returns the pointer on success
+// Returns NULL if failed
+void * evlogCreate(FILE * hFile);
+
+// Appends an event, writing a chunk once it is full
+// Returns 1 on success
+// Returns 0 if failed
+int evlogAppend(void * hWriter, const EVENT * event);
+
+// Writes the last chunk and deletes the writer, the file is left open
+// Returns 1 on success
+// Returns 0 if a write failed since the writer was created
+int evlogFinish(void * hWriter);
+
+// READER FUNCTIONS
+
+// Opens a log
+// Returns the pointer on success
+// Returns NULL if the file cannot be read or is not a log
+void * evlogOpen(const char * fileName);
+
+// Closes a log
+void evlogClose(void * hReader);
+
+// Reads the next event of the log that passes the filter (NULL for every event)
+// Returns 1 if an event was read
+// Returns 0 at the end of the log
+int evlogNext(void * hReader, const EVLOGFILTER * filter, EVENT * event);
+
+// Gets the number of chunks read and the number of chunks skipped by their minimum and maximum values
+void evlogChunks(void * hReader, unsigned long long * pRead, unsigned long long * pSkipped);
+
+#endif
@@ -0,0 +1,95 @@
+#include <string.h>
+#include "evlog.h"
+
+// Prints the events of a binary event log (allocate -o binary:<file>) as text lines,
+// STOPPED lines included. Chunks that cannot hold a selected event are skipped unread.
+// Usage: evlogcat <file> [-p <pid>[,<last pid>]] [-t <first tick>,<last tick>] [-v]
+//   -v reports the number of chunks read and skipped on stderr
+
+// Reads an inclusive range "<first>[,<last>]", a single value selects itself
+// Returns 1 on success
+// Returns 0 if the range is malformed
+static int readRange(const char * sRange, unsigned long long * pFrom, unsigned long long * pTo) {
+    char * sEnd = NULL;
+    unsigned long long from = strtoull(sRange, &sEnd, 10);
+    unsigned long long to = from;
+
+    if (sEnd == sRange) {
+        return 0;
+    }
+    if (*sEnd == ',') {
+        const char * sTo = sEnd + 1;
+        to = strtoull(sTo, &sEnd, 10);
+        if (sEnd == sTo) {
+            return 0;
+        }
+    }
+
+    *pFrom = from;
+    *pTo = to;
+    return *sEnd == '\0' && from <= to;
+}
+
+int main(int argc, char** argv) {
+    EVLOGFILTER filter = { 0, ~0ULL, 0, 0xffffffffu };
+    const char * fileName = NULL;
+    int verbose = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "-t") == 0) && i + 1 < argc) {
+            unsigned long long from = 0, to = 0;
+            int valid = readRange(argv[i+1], &from, &to);
+            if (argv[i][1] == 'p') {
+                valid = valid && to <= 0xffffffffULL; // pids are 32 bit
+                filter.pidFrom = (unsigned int)from;
+                filter.pidTo = (unsigned int)to;
+            } else {
+                filter.timeFrom = from;
+                filter.timeTo = to;
+            }
+            if (!valid) {
+                fprintf(stderr, "%s option expects a value or an inclusive range <first>,<last>.\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            i++; // skip
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = 1;
+        } else {
+            fileName = argv[i];
+        }
+    }
+
+    if (!fileName) {
+        fprintf(stderr, "Usage: evlogcat <file> [-p <pid>[,<last pid>]] [-t <first tick>,<last tick>] [-v]\n");
+        return EXIT_FAILURE;
+    }
+
+    void * hReader = evlogOpen(fileName);
+    if (!hReader) {
+        fprintf(stderr, "%s is not a readable event log.\n", fileName);
+        return EXIT_FAILURE;
+    }
+
+    void * hSink = sinkCreate(SINK_TEXT, stdout, 0);
+    if (!hSink) {
+        evlogClose(hReader);
+        fprintf(stderr, "Failed to create the event sink.\n");
+        return EXIT_FAILURE;
+    }
+
+    EVENT event;
+    while (evlogNext(hReader, &filter, &event)) {
+        sinkWrite(hSink, &event);
+    }
+
+    if (verbose) {
+        unsigned long long read = 0, skipped = 0;
+        evlogChunks(hReader, &read, &skipped);
+        fprintf(stderr, "chunks read %llu, skipped %llu\n", read, skipped);
+    }
+
+    sinkDelete(hSink);
+    evlogClose(hReader);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,500 @@
+#include "fair.h"
+#include "cpu.h"
+
+// Virtual times are fixed point, in 1/FAIR_SCALE ticks of work
+#define FAIR_SCALE 1024ULL
+
+// Define struct for a queued sub process
+typedef struct {
+    unsigned long long tag; // virtual finish time
+    unsigned int pid;
+    void * hSubProc;
+} FAIRENTRY;
+
+// Define struct for the queue of a cpu, a heap by finish time (ties by pid)
+typedef struct {
+    FAIRENTRY * entries;
+    size_t count;
+    size_t size;
+    unsigned long long load; // remaining time of the queued sub processes
+} FAIRQUEUE;
+
+// Define struct for the fair share state
+typedef struct {
+    unsigned int processors;
+    unsigned int tenants;
+    unsigned int * weights; // weight of each tenant
+    unsigned long long * vtime; // virtual time of each cpu
+    unsigned long long * maxTag; // latest finish time given on each cpu
+    unsigned long long * finish; // finish time of the last sub process of each tenant on each cpu (cpu major)
+    FAIRQUEUE * queues; // queued sub processes of each cpu
+    int fresh; // the cpus were read on the tick below
+    unsigned long long time;
+    unsigned long long * ends; // tick each cpu runs out of work, an idle cpu is at most the current tick
+    size_t leaves; // number of leaves of the trees, a power of two
+    unsigned int * trees; // per tenant, the best cpu below each position, cpu i at leaves + i (tenant major)
+    size_t * heap; // positions to visit during a ranking, best first
+} FAIRINFO;
+
+// Helper functions declaration
+
+// Advances the virtual time of a cpu to the finish time of its running sub process
+// An idle cpu has served every tenant, so its virtual time catches up with the latest finish time
+// Returns the virtual time
+static unsigned long long fairClock(FAIRINFO * fair, void * processor);
+
+// Checks if a queued sub process runs before another one
+// Returns 1 if it does
+// Returns 0 otherwise
+static int fairEarlier(unsigned long long tag, unsigned int pid, unsigned long long otherTag, unsigned int otherPid);
+
+// Adds a sub process to the queue of a cpu
+// Returns 1 on success
+// Returns 0 if failed
+static int fairPush(FAIRQUEUE * queue, void * hSubProc);
+
+// Takes the sub process with the earliest finish time from the queue of a cpu
+static void * fairPop(FAIRQUEUE * queue);
+
+// Preempts the current sub process of a processor for an earlier queued one, or hands the earliest
+// queued sub process to the processor when it is idle
+// Returns 1 on success
+// Returns 0 if failed
+static int fairSettle(FAIRINFO * fair, void * processor);
+
+// Reads the virtual time and the remaining time of a cpu and updates the trees where its key changed,
+// the tree of the given tenant always (tenants for none)
+static void fairRefresh(FAIRINFO * fair, void * processor, unsigned int tenant);
+
+// Recomputes the positions above a cpu in the tree of a tenant
+static void fairUpdate(FAIRINFO * fair, unsigned int tenant, unsigned int cpu);
+
+// Checks if a cpu comes before another one in the tree of a tenant
+// Returns 1 if it does
+// Returns 0 otherwise
+static int fairBefore(FAIRINFO * fair, unsigned int tenant, unsigned int a, unsigned int b);
+
+// Checks if a tree position comes before another one in the order of a ranking
+// Returns 1 if it does
+// Returns 0 otherwise
+static int fairVisitBefore(FAIRINFO * fair, unsigned int tenant, size_t a, size_t b);
+
+// Adds a tree position to the heap of a ranking
+static void fairVisitPush(FAIRINFO * fair, unsigned int tenant, size_t * pCount, size_t position);
+
+// Takes the first tree position from the heap of a ranking
+static size_t fairVisitPop(FAIRINFO * fair, unsigned int tenant, size_t * pCount);
+
+#define FAIR(h) if (!h) { return 0; } FAIRINFO * fair = (FAIRINFO*)h;
+#define FAIRN(h) if (!h) { return; } FAIRINFO * fair = (FAIRINFO*)h;
+
+// Creates the fair share state of the cpus
+void * fairCreate(unsigned int processors, const unsigned int * weights, unsigned int tenants) {
+    if (processors == 0 || tenants == 0) {
+        return NULL;
+    }
+
+    FAIRINFO * fair = (FAIRINFO *)calloc(1, sizeof(FAIRINFO));
+    if (!fair) {
+        return NULL;
+    }
+
+    fair->processors = processors;
+    fair->tenants = tenants;
+
+    fair->leaves = 1;
+    while (fair->leaves < processors) {
+        fair->leaves *= 2;
+    }
+
+    fair->weights = (unsigned int *)calloc(tenants, sizeof(unsigned int));
+    fair->vtime = (unsigned long long *)calloc(processors, sizeof(unsigned long long));
+    fair->maxTag = (unsigned long long *)calloc(processors, sizeof(unsigned long long));
+    fair->finish = (unsigned long long *)calloc((size_t)processors * tenants, sizeof(unsigned long long));
+    fair->queues = (FAIRQUEUE *)calloc(processors, sizeof(FAIRQUEUE));
+    fair->ends = (unsigned long long *)calloc(processors, sizeof(unsigned long long));
+    fair->trees = (unsigned int *)calloc(2 * fair->leaves * tenants, sizeof(unsigned int));
+    fair->heap = (size_t *)calloc(2 * fair->leaves, sizeof(size_t));
+
+    if (!fair->weights || !fair->vtime || !fair->maxTag || !fair->finish || !fair->queues || !fair->ends || !fair->trees || !fair->heap) {
+        fairDelete(fair);
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < tenants; i++) {
+        fair->weights[i] = weights[i] ? weights[i] : 1;
+    }
+
+    // every cpu starts idle with nothing queued, so the trees are in the order of the ids;
+    // the padding leaves hold the number of cpus and never come out of a ranking
+    for (unsigned int t = 0; t < tenants; t++) {
+        unsigned int * tree = fair->trees + 2 * fair->leaves * t;
+        for (size_t i = 0; i < fair->leaves; i++) {
+            tree[fair->leaves + i] = i < processors ? (unsigned int)i : processors;
+        }
+        for (size_t position = fair->leaves - 1; position > 0; position--) {
+            tree[position] = tree[2 * position];
+        }
+    }
+
+    return fair;
+}
+
+// Deletes the fair share state
+void fairDelete(void * hFair) {
+    FAIRN(hFair)
+
+    if (fair->queues) {
+        for (unsigned int i = 0; i < fair->processors; i++) {
+            free(fair->queues[i].entries);
+        }
+    }
+
+    free(fair->weights);
+    free(fair->vtime);
+    free(fair->maxTag);
+    free(fair->finish);
+    free(fair->queues);
+    free(fair->ends);
+    free(fair->trees);
+    free(fair->heap);
+    free(fair);
+}
+
+// Hands the earliest queued sub process to each idle processor
+int fairDispatch(void * hFair, void * hProcessors) {
+    FAIR(hFair)
+
+    for (unsigned int i = 0; i < fair->processors; i++) {
+        if (fair->queues[i].count > 0 && !fairSettle(fair, listGet(hProcessors, i))) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+// Selects the k cpus where the tenant has the least weighted work queued
+// The tree of the tenant is walked best first by the key of the best cpu below each position, with
+// its end of work taken no earlier than the current tick and then the first leaf below the position.
+// That never exceeds the key of a cpu below it, so the cpus come out in order.
+// The processors worked since the previous tick, so the first ranking of a tick reads every cpu; the
+// trees are only updated for the cpus whose virtual time or end of work changed, which a busy cpu
+// keeps until its next dispatch. Within a tick only the cpus the sub processes were queued on change.
+void fairRank(void * hFair, void * hProcessors, unsigned long long time, unsigned int tenant, size_t k, unsigned int * ranked) {
+    FAIRN(hFair)
+
+    if (!fair->fresh || fair->time != time) {
+        fair->fresh = 1;
+        fair->time = time;
+        for (unsigned int i = 0; i < fair->processors; i++) {
+            fairRefresh(fair, listGet(hProcessors, i), fair->tenants);
+        }
+    }
+
+    unsigned int * tree = fair->trees + 2 * fair->leaves * tenant;
+    size_t placed = 0, count = 0;
+
+    fairVisitPush(fair, tenant, &count, 1);
+    while (count > 0 && placed < k) {
+        size_t position = fairVisitPop(fair, tenant, &count);
+
+        if (position >= fair->leaves) {
+            ranked[placed++] = (unsigned int)(position - fair->leaves);
+            continue;
+        }
+
+        for (size_t child = 2 * position; child <= 2 * position + 1; child++) {
+            if (tree[child] < fair->processors) {
+                fairVisitPush(fair, tenant, &count, child);
+            }
+        }
+    }
+}
+
+// Tags a sub process with its virtual finish time on a processor and queues it by finish time
+int fairAssign(void * hFair, void * hProcessor, void * hSubProc, unsigned int tenant) {
+    FAIR(hFair)
+
+    unsigned int cpu = processorID(hProcessor);
+    if (cpu >= fair->processors || tenant >= fair->tenants) {
+        return 0;
+    }
+
+    unsigned long long * finish = &fair->finish[(size_t)cpu * fair->tenants + tenant];
+    unsigned long long vtime = fairClock(fair, hProcessor);
+
+    // the virtual times saturate instead of wrapping around
+    unsigned long long tag = *finish > vtime ? *finish : vtime;
+    unsigned long long rem = subProcRem(hSubProc);
+    unsigned long long share = rem > ~0ULL / FAIR_SCALE ? ~0ULL : rem * FAIR_SCALE / fair->weights[tenant];
+    tag = share > ~0ULL - tag ? ~0ULL : tag + share;
+    *finish = tag;
+    if (tag > fair->maxTag[cpu]) {
+        fair->maxTag[cpu] = tag;
+    }
+    subProcSetTag(hSubProc, tag);
+
+    if (!fairPush(&fair->queues[cpu], hSubProc) || !fairSettle(fair, hProcessor)) {
+        return 0;
+    }
+
+    // the finish time of the tenant changed even if the cpu did not
+    fairRefresh(fair, hProcessor, tenant);
+
+    return 1;
+}
+
+// helper function definitions
+
+// Advances the virtual time of a cpu to the finish time of its running sub process
+static unsigned long long fairClock(FAIRINFO * fair, void * processor) {
+    unsigned int cpu = processorID(processor);
+    void * hCurrentSubProc = processorCurrentSubProc(processor);
+
+    if (hCurrentSubProc && subProcRem(hCurrentSubProc) > 0) {
+        unsigned long long tag = subProcTag(hCurrentSubProc);
+        if (tag > fair->vtime[cpu]) {
+            fair->vtime[cpu] = tag;
+        }
+    } else if (listCount(processorPending(processor)) == 0 && fair->queues[cpu].count == 0) {
+        fair->vtime[cpu] = fair->maxTag[cpu];
+    }
+
+    return fair->vtime[cpu];
+}
+
+// Checks if a queued sub process runs before another one
+static int fairEarlier(unsigned long long tag, unsigned int pid, unsigned long long otherTag, unsigned int otherPid) {
+    return tag < otherTag || (tag == otherTag && pid < otherPid);
+}
+
+// Adds a sub process to the queue of a cpu
+static int fairPush(FAIRQUEUE * queue, void * hSubProc) {
+    if (queue->count == queue->size) {
+        size_t size = queue->size ? queue->size * 2 : 16;
+        FAIRENTRY * grown = (FAIRENTRY *)realloc(queue->entries, size * sizeof(FAIRENTRY));
+        if (!grown) {
+            return 0;
+        }
+        queue->entries = grown;
+        queue->size = size;
+    }
+
+    FAIRENTRY entry;
+    entry.tag = subProcTag(hSubProc);
+    entry.pid = procID(subProcParent(hSubProc));
+    entry.hSubProc = hSubProc;
+
+    size_t i = queue->count++;
+    while (i > 0 && fairEarlier(entry.tag, entry.pid, queue->entries[(i - 1) / 2].tag, queue->entries[(i - 1) / 2].pid)) {
+        queue->entries[i] = queue->entries[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    queue->entries[i] = entry;
+    queue->load += subProcRem(hSubProc);
+
+    return 1;
+}
+
+// Takes the sub process with the earliest finish time from the queue of a cpu
+static void * fairPop(FAIRQUEUE * queue) {
+    void * hSubProc = queue->entries[0].hSubProc;
+    FAIRENTRY last = queue->entries[--queue->count];
+    size_t i = 0;
+
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= queue->count) {
+            break;
+        }
+        FAIRENTRY * entries = queue->entries;
+        if (child + 1 < queue->count && fairEarlier(entries[child + 1].tag, entries[child + 1].pid, entries[child].tag, entries[child].pid)) {
+            child++;
+        }
+        if (!fairEarlier(entries[child].tag, entries[child].pid, last.tag, last.pid)) {
+            break;
+        }
+        entries[i] = entries[child];
+        i = child;
+    }
+    if (queue->count > 0) {
+        queue->entries[i] = last;
+    }
+
+    queue->load -= subProcRem(hSubProc);
+
+    return hSubProc;
+}
+
+// Preempts the current sub process of a processor for an earlier queued one, or hands the earliest
+// queued sub process to the processor when it is idle
+// The processor runs the front of its pending list as soon as it has no current sub process, so at
+// most one handed over sub process waits there, and an earlier one that arrived since takes its place
+static int fairSettle(FAIRINFO * fair, void * processor) {
+    FAIRQUEUE * queue = &fair->queues[processorID(processor)];
+    if (queue->count == 0) {
+        return 1;
+    }
+
+    FAIRENTRY * first = &queue->entries[0];
+    void * hCurrentSubProc = processorCurrentSubProc(processor);
+
+    if (hCurrentSubProc && subProcRem(hCurrentSubProc) > 0) {
+        if (first->tag >= subProcTag(hCurrentSubProc)) {
+            return 1; // keeps running
+        }
+        if (!fairPush(queue, hCurrentSubProc)) {
+            return 0;
+        }
+        processorClearCurrent(processor);
+    } else if (listCount(processorPending(processor)) > 0) {
+        void * hHanded = listGet(processorPending(processor), 0);
+        if (!fairEarlier(first->tag, first->pid, subProcTag(hHanded), procID(subProcParent(hHanded)))) {
+            return 1; // the handed over sub process is still the earliest
+        }
+        if (!fairPush(queue, processorDequeue(processor, 0))) {
+            return 0;
+        }
+    }
+
+    return processorEnqueue(processor, 0, fairPop(queue)) != 0;
+}
+
+// Reads the virtual time and the remaining time of a cpu and updates the trees where its key changed
+// An idle cpu runs out of work on the current tick, so its end is only rewritten once it is later.
+// The end of work is in the key of every tenant, the virtual time only in the keys of the tenants
+// with work queued ahead of it before or after.
+static void fairRefresh(FAIRINFO * fair, void * processor, unsigned int tenant) {
+    unsigned int cpu = processorID(processor);
+    unsigned long long vtime = fair->vtime[cpu];
+    unsigned long long newVtime = fairClock(fair, processor);
+    unsigned long long lower = newVtime < vtime ? newVtime : vtime;
+    int ended = 0;
+
+    // the end of work saturates instead of wrapping around
+    unsigned long long rem = processorRemainingTime(processor) + fair->queues[cpu].load;
+    unsigned long long end = rem > ~0ULL - fair->time ? ~0ULL : fair->time + rem;
+    if (end != fair->ends[cpu] && (rem > 0 || fair->ends[cpu] > fair->time)) {
+        fair->ends[cpu] = end;
+        ended = 1;
+    }
+
+    if (!ended && newVtime == vtime && tenant >= fair->tenants) {
+        return;
+    }
+
+    // a tenant has no work ahead of either virtual time if it has none ahead of the lower one
+    const unsigned long long * finish = &fair->finish[(size_t)cpu * fair->tenants];
+    for (unsigned int t = 0; t < fair->tenants; t++) {
+        if (ended || t == tenant || (newVtime != vtime && finish[t] > lower)) {
+            fairUpdate(fair, t, cpu);
+        }
+    }
+}
+
+// Recomputes the positions above a cpu in the tree of a tenant
+// Once a position keeps another cpu than before the ones above it keep theirs too
+static void fairUpdate(FAIRINFO * fair, unsigned int tenant, unsigned int cpu) {
+    unsigned int * tree = fair->trees + 2 * fair->leaves * tenant;
+
+    for (size_t position = (fair->leaves + cpu) / 2; position > 0; position /= 2) {
+        unsigned int left = tree[2 * position], right = tree[2 * position + 1];
+        unsigned int best = fairBefore(fair, tenant, right, left) ? right : left;
+        if (best == tree[position] && best != cpu) {
+            break;
+        }
+        tree[position] = best;
+    }
+}
+
+// Checks if a cpu comes before another one in the tree of a tenant
+// A cpu is keyed by the work of the tenant ahead of its virtual time, then its end of work, then
+// its id; the padding leaves come last
+static int fairBefore(FAIRINFO * fair, unsigned int tenant, unsigned int a, unsigned int b) {
+    if (a >= fair->processors || b >= fair->processors) {
+        return a < b;
+    }
+
+    unsigned long long finishA = fair->finish[(size_t)a * fair->tenants + tenant];
+    unsigned long long finishB = fair->finish[(size_t)b * fair->tenants + tenant];
+    unsigned long long aheadA = finishA > fair->vtime[a] ? finishA - fair->vtime[a] : 0;
+    unsigned long long aheadB = finishB > fair->vtime[b] ? finishB - fair->vtime[b] : 0;
+
+    if (aheadA != aheadB) {
+        return aheadA < aheadB;
+    }
+    if (fair->ends[a] != fair->ends[b]) {
+        return fair->ends[a] < fair->ends[b];
+    }
+    return a < b;
+}
+
+// Checks if a tree position comes before another one in the order of a ranking
+// The end of work of an idle cpu is the current tick
+static int fairVisitBefore(FAIRINFO * fair, unsigned int tenant, size_t a, size_t b) {
+    unsigned int * tree = fair->trees + 2 * fair->leaves * tenant;
+    unsigned int cpuA = tree[a], cpuB = tree[b];
+
+    unsigned long long finishA = fair->finish[(size_t)cpuA * fair->tenants + tenant];
+    unsigned long long finishB = fair->finish[(size_t)cpuB * fair->tenants + tenant];
+    unsigned long long aheadA = finishA > fair->vtime[cpuA] ? finishA - fair->vtime[cpuA] : 0;
+    unsigned long long aheadB = finishB > fair->vtime[cpuB] ? finishB - fair->vtime[cpuB] : 0;
+
+    if (aheadA != aheadB) {
+        return aheadA < aheadB;
+    }
+
+    unsigned long long endA = fair->ends[cpuA] > fair->time ? fair->ends[cpuA] : fair->time;
+    unsigned long long endB = fair->ends[cpuB] > fair->time ? fair->ends[cpuB] : fair->time;
+    if (endA != endB) {
+        return endA < endB;
+    }
+
+    // first leaf below each position
+    while (a < fair->leaves) {
+        a *= 2;
+    }
+    while (b < fair->leaves) {
+        b *= 2;
+    }
+    return a < b;
+}
+
+// Adds a tree position to the heap of a ranking
+static void fairVisitPush(FAIRINFO * fair, unsigned int tenant, size_t * pCount, size_t position) {
+    size_t i = (*pCount)++;
+
+    while (i > 0 && fairVisitBefore(fair, tenant, position, fair->heap[(i - 1) / 2])) {
+        fair->heap[i] = fair->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    fair->heap[i] = position;
+}
+
+// Takes the first tree position from the heap of a ranking
+static size_t fairVisitPop(FAIRINFO * fair, unsigned int tenant, size_t * pCount) {
+    size_t first = fair->heap[0];
+    size_t last = fair->heap[--(*pCount)];
+    size_t i = 0;
+
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= *pCount) {
+            break;
+        }
+        if (child + 1 < *pCount && fairVisitBefore(fair, tenant, fair->heap[child + 1], fair->heap[child])) {
+            child++;
+        }
+        if (!fairVisitBefore(fair, tenant, fair->heap[child], last)) {
+            break;
+        }
+        fair->heap[i] = fair->heap[child];
+        i = child;
+    }
+    if (*pCount > 0) {
+        fair->heap[i] = last;
+    }
+
+    return first;
+}
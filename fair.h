@@ -0,0 +1,43 @@
+#ifndef FAIR_H_
+#define FAIR_H_
+
+// Include dependencies
+#include <stdlib.h>
+
+// Defines the weighted fair sharing of the cpus between tenants.
+// Each cpu runs self-clocked weighted fair queueing: a sub process queued on a cpu gets the virtual
+// finish time start + remaining time / weight of its tenant, where start is the later of the cpu
+// virtual time and the finish time of the previous sub process of the tenant on that cpu. The cpu
+// virtual time follows the finish time of the running sub process. Pending sub processes run by
+// finish time, so a tenant flooding a cpu only delays its own work.
+// An arriving process goes to the cpus where its tenant has the least work queued ahead of the cpu
+// virtual time, ties broken by the least remaining time.
+// The queued sub processes of each cpu are kept in a heap by finish time and the cpus in one tree
+// per tenant, so queueing a sub process and ranking the cpus take logarithmic time.
+
+// Creates the fair share state of the cpus for tenants with the given weights (at least 1)
+// Returns the pointer on success
+// Returns NULL if failed
+void * fairCreate(unsigned int processors, const unsigned int * weights, unsigned int tenants);
+
+// Deletes the fair share state
+void fairDelete(void * hFair);
+
+// Hands the queued sub process with the earliest finish time to each idle processor at the start of
+// a tick
+// Returns 1 on success
+// Returns 0 if failed
+int fairDispatch(void * hFair, void * hProcessors);
+
+// Selects the k cpus where the tenant has the least weighted work queued, ties broken by the
+// least remaining time and then the smaller id
+// Writes the ids of the selected cpus to ranked
+void fairRank(void * hFair, void * hProcessors, unsigned long long time, unsigned int tenant, size_t k, unsigned int * ranked);
+
+// Tags a sub process of the tenant with its virtual finish time on a processor and queues it by
+// finish time; it preempts the current sub process if its finish time is earlier
+// Returns 1 on success
+// Returns 0 if failed
+int fairAssign(void * hFair, void * hProcessor, void * hSubProc, unsigned int tenant);
+
+#endif
@@ -0,0 +1,235 @@
+#include "gang.h"
+#include "cpu.h"
+
+#define GANG_LAUNCHED ((unsigned int)-1) // claim of the cpus of a gang launched on this tick
+
+// Define struct for a gang waiting to launch
+typedef struct {
+    void * hProc;
+    unsigned int count; // number of sub processes
+    unsigned int * cpus; // cpu of each sub process
+} GANG;
+
+// Define struct for the gang scheduler
+typedef struct {
+    unsigned int processors;
+    GANGPOLICY policy;
+    void * hWaiting; // gangs that have not launched, oldest first
+    unsigned int * claims; // index + 1 of the gang that claimed each cpu on this tick (0 if none, GANG_LAUNCHED if taken)
+    unsigned long long heldTime; // cpu ticks held idle while work was pending
+} GANGINFO;
+
+// Helper functions declaration
+
+// Checks if a cpu is free to start a gang member on this tick
+static int gangCpuFree(void * processor);
+
+// Checks if a process is a gang that has not launched yet
+static int gangWaiting(GANGINFO * gang, void * hProc);
+
+// Moves the first pending sub process that is not a waiting gang member and
+// completes within shadow ticks to the front of the pending list
+// Returns 1 if a sub process was found
+// Returns 0 otherwise
+static int gangBackfill(GANGINFO * gang, void * processor, unsigned long long shadow);
+
+// Moves a pending sub process to the front of the pending list
+// Returns 1 on success
+// Returns 0 if failed
+static int gangPromote(void * processor, void * hSubProc);
+
+#define GNG(h) if (!h) { return 0; } GANGINFO * gang = (GANGINFO*)h;
+#define GNGN(h) if (!h) { return; } GANGINFO * gang = (GANGINFO*)h;
+
+// Creates the gang scheduler
+void * gangCreate(unsigned int processors, GANGPOLICY policy) {
+    GANGINFO * gang = (GANGINFO *)calloc(1, sizeof(GANGINFO));
+    if (!gang) {
+        return NULL;
+    }
+
+    gang->processors = processors;
+    gang->policy = policy;
+    gang->hWaiting = listCreate();
+    gang->claims = (unsigned int *)calloc(processors, sizeof(unsigned int));
+
+    if (!gang->hWaiting || !gang->claims) {
+        gangDelete(gang);
+        return NULL;
+    }
+
+    return gang;
+}
+
+// Deletes the gang scheduler
+void gangDelete(void * hGang) {
+    GNGN(hGang)
+
+    size_t count = listCount(gang->hWaiting);
+    for (size_t i = 0; i < count; i++) {
+        GANG * waiting = (GANG *)listGet(gang->hWaiting, i);
+        free(waiting->cpus);
+        free(waiting);
+    }
+
+    listDelete(gang->hWaiting);
+    free(gang->claims);
+    free(gang);
+}
+
+// Registers a parallel process whose sub process j was queued on cpu cpus[j]
+int gangAdd(void * hGang, void * hProc, const unsigned int * cpus) {
+    GNG(hGang)
+
+    GANG * waiting = (GANG *)calloc(1, sizeof(GANG));
+    if (!waiting) {
+        return 0;
+    }
+
+    waiting->hProc = hProc;
+    waiting->count = procSubs(hProc);
+    waiting->cpus = (unsigned int *)malloc(waiting->count * sizeof(unsigned int));
+    if (!waiting->cpus || !listPush(gang->hWaiting, waiting)) {
+        free(waiting->cpus);
+        free(waiting);
+        return 0;
+    }
+
+    memcpy(waiting->cpus, cpus, waiting->count * sizeof(unsigned int));
+
+    return 1;
+}
+
+// Launches the gangs whose cpus are all free, and holds or backfills the cpus waiting for a gang
+void gangDispatch(void * hGang, void * hProcessors) {
+    GNGN(hGang)
+
+    memset(gang->claims, 0, gang->processors * sizeof(unsigned int));
+    for (unsigned int i = 0; i < gang->processors; i++) {
+        processorHold(listGet(hProcessors, i), 0);
+    }
+
+    // oldest gangs first
+    for (size_t i = 0; i < listCount(gang->hWaiting);) {
+        GANG * waiting = (GANG *)listGet(gang->hWaiting, i);
+        int launch = 1;
+
+        for (unsigned int j = 0; j < waiting->count; j++) {
+            unsigned int cpu = waiting->cpus[j];
+            if (gang->claims[cpu] || !gangCpuFree(listGet(hProcessors, cpu))) {
+                launch = 0;
+            }
+        }
+
+        if (launch) {
+            // every member goes to the front of its cpu and is dispatched on this step, so no younger
+            // gang may launch on these cpus on this tick
+            for (unsigned int j = 0; j < waiting->count; j++) {
+                gangPromote(listGet(hProcessors, waiting->cpus[j]), listGet(procSubsHandle(waiting->hProc), j));
+                gang->claims[waiting->cpus[j]] = GANG_LAUNCHED;
+            }
+
+            listRemove(gang->hWaiting, i);
+            free(waiting->cpus);
+            free(waiting);
+            continue;
+        }
+
+        for (unsigned int j = 0; j < waiting->count; j++) {
+            unsigned int cpu = waiting->cpus[j];
+            if (!gang->claims[cpu]) {
+                gang->claims[cpu] = (unsigned int)i + 1;
+            }
+        }
+        i++;
+    }
+
+    // hold or backfill the free cpus claimed by a waiting gang
+    for (unsigned int cpu = 0; cpu < gang->processors; cpu++) {
+        void * processor = listGet(hProcessors, cpu);
+
+        if (!gang->claims[cpu] || gang->claims[cpu] == GANG_LAUNCHED || !gangCpuFree(processor) ||
+            listCount(processorPending(processor)) == 0) {
+            continue;
+        }
+
+        if (gang->policy == GANG_BACKFILL) {
+            // the gang cannot launch before its busiest cpu is free
+            GANG * waiting = (GANG *)listGet(gang->hWaiting, gang->claims[cpu] - 1);
+            unsigned long long shadow = 0;
+            for (unsigned int j = 0; j < waiting->count; j++) {
+                void * hCurrentSubProc = processorCurrentSubProc(listGet(hProcessors, waiting->cpus[j]));
+                if (hCurrentSubProc && subProcRem(hCurrentSubProc) > shadow) {
+                    shadow = subProcRem(hCurrentSubProc);
+                }
+            }
+
+            if (gangBackfill(gang, processor, shadow)) {
+                continue;
+            }
+        }
+
+        processorHold(processor, 1);
+        gang->heldTime++;
+    }
+}
+
+// Gets the number of cpu ticks held idle while work was pending
+unsigned long long gangHeldTime(void * hGang) {
+    GNG(hGang)
+
+    return gang->heldTime;
+}
+
+// helper function definitions
+
+// Checks if a cpu is free to start a gang member on this tick
+static int gangCpuFree(void * processor) {
+    void * hCurrentSubProc = processorCurrentSubProc(processor);
+
+    return !hCurrentSubProc || subProcRem(hCurrentSubProc) == 0;
+}
+
+// Checks if a process is a gang that has not launched yet
+static int gangWaiting(GANGINFO * gang, void * hProc) {
+    size_t count = listCount(gang->hWaiting);
+
+    for (size_t i = 0; i < count; i++) {
+        if (((GANG *)listGet(gang->hWaiting, i))->hProc == hProc) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Moves the first pending sub process that is not a waiting gang member and
+// completes within shadow ticks to the front of the pending list
+static int gangBackfill(GANGINFO * gang, void * processor, unsigned long long shadow) {
+    void * pending = processorPending(processor);
+    size_t count = listCount(pending);
+
+    for (size_t i = 0; i < count; i++) {
+        void * hSubProc = listGet(pending, i);
+        if (subProcRem(hSubProc) <= shadow && !gangWaiting(gang, subProcParent(hSubProc))) {
+            return gangPromote(processor, hSubProc);
+        }
+    }
+
+    return 0;
+}
+
+// Moves a pending sub process to the front of the pending list
+static int gangPromote(void * processor, void * hSubProc) {
+    size_t index = 0;
+
+    if (!listSearch(processorPending(processor), hSubProc, &index)) {
+        return 0;
+    }
+
+    if (index == 0) {
+        return 1;
+    }
+
+    return processorDequeue(processor, index) && processorEnqueue(processor, 0, hSubProc);
+}
@@ -0,0 +1,40 @@
+#ifndef GANG_H_
+#define GANG_H_
+
+// Include dependencies
+#include <stdlib.h>
+
+// Defines the gang scheduling of parallel processes.
+// The sub processes of a gang start on the same tick, once every cpu they were assigned to is free.
+// Gangs launch in the order they arrived: each gang claims the cpus it needs that no older gang claimed,
+// so the oldest gang always gets all of its cpus and no two gangs wait on each other.
+// A free cpu claimed by a waiting gang is either held idle, or backfilled with the first pending
+// sub process that completes before the busiest cpu of the gang becomes free.
+
+// Policies for the cpus that wait for a gang
+typedef enum {
+    GANG_HOLD = 0, // keep the cpu idle until the gang launches
+    GANG_BACKFILL  // run shorter work that does not delay the launch
+} GANGPOLICY;
+
+// Creates the gang scheduler
+// Returns the pointer on success
+// Returns NULL if failed
+void * gangCreate(unsigned int processors, GANGPOLICY policy);
+
+// Deletes the gang scheduler
+void gangDelete(void * hGang);
+
+// Registers a parallel process whose sub process j was queued on cpu cpus[j]
+// Returns 1 on success
+// Returns 0 if failed
+int gangAdd(void * hGang, void * hProc, const unsigned int * cpus);
+
+// Launches the gangs whose cpus are all free, and holds or backfills the cpus waiting for a gang
+// Must run after the arrivals of the tick and before the processors step
+void gangDispatch(void * hGang, void * hProcessors);
+
+// Gets the number of cpu ticks held idle while work was pending
+unsigned long long gangHeldTime(void * hGang);
+
+#endif
@@ -4,11 +4,19 @@
 typedef struct {
     void ** array;
     size_t count;
+    size_t size; // capacity of the array, grown geometrically so appending takes amortised constant time
 } LIST;
 
 #define LIST(h) if (!h) { return 0; } LIST* list = (LIST*)h;
 #define LISTN(h) if (!h) { return; } LIST* list = (LIST*)h;
 
+// Helper functions declaration
+
+// Grows the array to hold the given number of items
+// Returns 1 on success
+// Returns 0 if failed (the list is unchanged)
+static int listReserve(LIST * list, size_t count);
+
 // Creates a handle of a list
 // Returns the pointer of the handle on success
 // Returns NULL otherwise
@@ -53,19 +61,16 @@ size_t listInsert(void * hList, size_t index, void * pNewItem) {
     size_t prevCount = list->count;
 
     if (index >= list->count) { // extend the list to accomodate out of range insertion
-        list->count = index + 1;
-
-        list->array = (void**)realloc(list->array, sizeof(void *) * (list->count));
-
-        if (!list->array) {
-            list->count = 0;
+        if (!listReserve(list, index + 1)) {
             return 0; // failed to reallocate
-        } 
+        }
+        list->count = index + 1;
     } else {
+        if (!listReserve(list, list->count + 1)) {
+            return 0; // failed to reallocate
+        }
         list->count++;   
 
-        list->array = (void**)realloc(list->array, sizeof(void *) * (list->count)); 
-
         // loop from the end
         // shift items
         for (long int j = (long int)prevCount - 1; j >= (long int)index; j--) {
@@ -93,9 +98,7 @@ void listSet(void * hList, size_t index, void * pItem) {
 size_t listPush(void * hList, void * pNewItem) {
     LIST(hList)
 
-    list->array = (void**)realloc(list->array, sizeof(void *) * (list->count + 1));
-
-    if (list->array == NULL) {
+    if (!listReserve(list, list->count + 1)) {
         return list->count;
     }
 
@@ -104,6 +107,17 @@ size_t listPush(void * hList, void * pNewItem) {
     return ++list->count;
 }
 
+// Removes all the items of the list
+// Does not destroys the item pointers of the list
+void listClear(void * hList) {
+    LISTN(hList)
+
+    free(list->array);
+    list->array = NULL;
+    list->count = 0;
+    list->size = 0;
+}
+
 // Delete the list
 // Does not destroys the item pointers of the list
 void listDelete(void * hList) {
@@ -130,17 +144,7 @@ void * listRemove(void * hList, size_t index) {
         list->array[j - 1] = list->array[j];
     }
 
-    list->count--;
-
-    if (list->count > 0) {
-        list->array = (void**)realloc(list->array, sizeof(void*) * (list->count));
-        if (!list->array) {
-            return NULL;
-        }
-    } else {
-        free(list->array);
-        list->array = NULL;
-    }
+    list->count--; // the array keeps its capacity for the next insertions
 
     return removedItem;
 }
@@ -167,4 +171,26 @@ int listSearch(void * hList, void * item, size_t* pIndex) {
         }
         return 1;
     }  
+}
+// helper function definitions
+
+// Grows the array to hold the given number of items
+static int listReserve(LIST * list, size_t count) {
+    if (count <= list->size) {
+        return 1;
+    }
+
+    size_t size = list->size ? list->size * 2 : 4;
+    if (size < count) {
+        size = count;
+    }
+
+    void ** array = (void**)realloc(list->array, sizeof(void *) * size);
+    if (!array) {
+        return 0;
+    }
+    list->array = array;
+    list->size = size;
+
+    return 1;
 }
\ No newline at end of file
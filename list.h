@@ -32,6 +32,10 @@ void listSet(void * hList, size_t index, void * pItem);
 // Returns the total number of items in the list after insertion
 size_t listPush(void * hList, void * pNewItem);
 
+// Removes all the items of the list
+// Does not destroys the item pointers of the list
+void listClear(void * hList);
+
 // Delete the list
 // Does not destroys the item pointers of the list
 void listDelete(void * hList);
@@ -0,0 +1,295 @@
+#include "mempool.h"
+#include "cpu.h"
+
+// Define struct for the memory pools
+typedef struct {
+    unsigned int processors;
+    unsigned int group; // cpus per node
+    unsigned int nodes;
+    unsigned long long capacity; // memory of each node
+    unsigned long long * nodeFree; // free memory of each node
+    size_t leaves; // number of leaves of the trees, a power of two
+    unsigned long long * loads; // least remaining time below each position, cpu i at leaves + i
+    unsigned long long * room; // most free memory below each position
+    int fresh; // the remaining times were read on the tick below
+    unsigned long long time;
+    unsigned int * touched; // cpus of the last placement, whose remaining time changed since
+    size_t touchedCount;
+    size_t * heap; // positions to visit during a placement, best first
+} MEMPOOL;
+
+// Helper functions declaration
+
+// Reads the remaining times of the cpus that may have changed since the last placement
+static void mempoolRefresh(MEMPOOL * pool, void * hProcessors, unsigned long long time);
+
+// Recomputes the positions above a leaf
+static void mempoolUpdate(MEMPOOL * pool, size_t position);
+
+// Sets the free memory of a node and updates the trees above its cpus
+static void mempoolSetFree(MEMPOOL * pool, unsigned int node, unsigned long long free);
+
+// Checks if a tree position comes before another one in the order of a placement
+// Returns 1 if it does
+// Returns 0 otherwise
+static int mempoolBefore(MEMPOOL * pool, size_t a, size_t b);
+
+// Adds a tree position to the heap of a placement
+static void mempoolPush(MEMPOOL * pool, size_t * pCount, size_t position);
+
+// Takes the first tree position from the heap of a placement
+static size_t mempoolPop(MEMPOOL * pool, size_t * pCount);
+
+#define MEM(h) if (!h) { return 0; } MEMPOOL * pool = (MEMPOOL*)h;
+#define MEMN(h) if (!h) { return; } MEMPOOL * pool = (MEMPOOL*)h;
+
+// Creates the memory pools of the cpus
+void * mempoolCreate(unsigned int processors, unsigned long long capacity, unsigned int group) {
+    if (processors == 0 || group == 0) {
+        return NULL;
+    }
+
+    MEMPOOL * pool = (MEMPOOL *)calloc(1, sizeof(MEMPOOL));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->processors = processors;
+    pool->group = group;
+    pool->nodes = (processors + group - 1) / group;
+    pool->capacity = capacity;
+
+    pool->leaves = 1;
+    while (pool->leaves < processors) {
+        pool->leaves *= 2;
+    }
+
+    pool->nodeFree = (unsigned long long *)calloc(pool->nodes, sizeof(unsigned long long));
+    pool->loads = (unsigned long long *)calloc(2 * pool->leaves, sizeof(unsigned long long));
+    pool->room = (unsigned long long *)calloc(2 * pool->leaves, sizeof(unsigned long long));
+    pool->touched = (unsigned int *)calloc(processors, sizeof(unsigned int));
+    pool->heap = (size_t *)calloc(2 * pool->leaves, sizeof(size_t));
+
+    if (!pool->nodeFree || !pool->loads || !pool->room || !pool->touched || !pool->heap) {
+        mempoolDelete(pool);
+        return NULL;
+    }
+
+    // the padding leaves have no room, so the placements never reach them
+    for (unsigned int i = 0; i < pool->nodes; i++) {
+        mempoolSetFree(pool, i, capacity);
+    }
+
+    return pool;
+}
+
+// Deletes the memory pools
+void mempoolDelete(void * hPool) {
+    MEMN(hPool)
+
+    free(pool->nodeFree);
+    free(pool->loads);
+    free(pool->room);
+    free(pool->touched);
+    free(pool->heap);
+    free(pool);
+}
+
+// Checks if k sub processes with the given demand each fit on the cpus when nothing is placed
+int mempoolFitsEmpty(void * hPool, unsigned long long demand, size_t k) {
+    MEM(hPool)
+
+    if (demand == 0) {
+        return k <= pool->processors;
+    }
+
+    size_t fits = 0;
+    unsigned long long perNode = pool->capacity / demand;
+    for (unsigned int i = 0; i < pool->nodes && fits < k; i++) {
+        unsigned int cpus = pool->processors - i * pool->group;
+        cpus = cpus < pool->group ? cpus : pool->group;
+        fits += perNode < cpus ? (size_t)perNode : cpus;
+    }
+
+    return fits >= k;
+}
+
+// Selects the k least loaded cpus whose node has room for the demand and reserves it
+// The tree is walked best first by (least remaining time, first cpu) below each position, which
+// never exceeds the key of a cpu below it, so the cpus come out in order of remaining time and id.
+// A node of several cpus may not have room for a sub process on each of them, so the demand is
+// reserved tentatively as the cpus come out.
+int mempoolPlace(void * hPool, void * hProcessors, unsigned long long time, unsigned long long demand, size_t k, unsigned int * ranked) {
+    MEM(hPool)
+
+    if (k == 0 || k > pool->processors || pool->room[1] < demand) {
+        return 0; // no node has room
+    }
+
+    mempoolRefresh(pool, hProcessors, time);
+
+    size_t placed = 0, count = 0;
+    mempoolPush(pool, &count, 1);
+    while (count > 0 && placed < k) {
+        size_t position = mempoolPop(pool, &count);
+
+        if (position < pool->leaves) {
+            for (size_t child = 2 * position; child <= 2 * position + 1; child++) {
+                if (pool->room[child] >= demand) {
+                    mempoolPush(pool, &count, child);
+                }
+            }
+            continue;
+        }
+
+        unsigned int cpu = (unsigned int)(position - pool->leaves);
+        if (cpu >= pool->processors) {
+            continue; // padding, only reached with no demand
+        }
+        unsigned long long * free = &pool->nodeFree[cpu / pool->group];
+        if (*free >= demand) {
+            *free -= demand; // tentative, the trees are updated once the placement is known
+            ranked[placed++] = cpu;
+        }
+    }
+
+    // give the tentative reservations back
+    for (size_t i = 0; i < placed; i++) {
+        pool->nodeFree[ranked[i] / pool->group] += demand;
+    }
+
+    if (placed < k) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < k; i++) {
+        unsigned int node = ranked[i] / pool->group;
+        mempoolSetFree(pool, node, pool->nodeFree[node] - demand);
+        pool->touched[i] = ranked[i];
+    }
+    pool->touchedCount = k;
+
+    return 1;
+}
+
+// Releases the demand of a sub process placed on a cpu
+void mempoolRelease(void * hPool, unsigned int cpu, unsigned long long demand) {
+    MEMN(hPool)
+
+    unsigned int node = cpu / pool->group;
+    mempoolSetFree(pool, node, pool->nodeFree[node] + demand);
+}
+
+// helper function definitions
+
+// Reads the remaining times of the cpus that may have changed since the last placement
+// Every cpu may have worked since the previous tick, within a tick only the cpus the sub
+// processes were queued on changed
+static void mempoolRefresh(MEMPOOL * pool, void * hProcessors, unsigned long long time) {
+    if (!pool->fresh || pool->time != time) {
+        for (size_t i = 0; i < pool->leaves; i++) {
+            pool->loads[pool->leaves + i] = i < pool->processors ? processorRemainingTime(listGet(hProcessors, i)) : ~0ULL;
+        }
+        for (size_t position = pool->leaves - 1; position > 0; position--) {
+            unsigned long long left = pool->loads[2 * position], right = pool->loads[2 * position + 1];
+            pool->loads[position] = left < right ? left : right;
+        }
+
+        pool->fresh = 1;
+        pool->time = time;
+        pool->touchedCount = 0;
+        return;
+    }
+
+    for (size_t i = 0; i < pool->touchedCount; i++) {
+        unsigned int cpu = pool->touched[i];
+        pool->loads[pool->leaves + cpu] = processorRemainingTime(listGet(hProcessors, cpu));
+        mempoolUpdate(pool, pool->leaves + cpu);
+    }
+    pool->touchedCount = 0;
+}
+
+// Recomputes the positions above a leaf
+static void mempoolUpdate(MEMPOOL * pool, size_t position) {
+    for (position /= 2; position > 0; position /= 2) {
+        unsigned long long left = pool->loads[2 * position], right = pool->loads[2 * position + 1];
+        pool->loads[position] = left < right ? left : right;
+        left = pool->room[2 * position];
+        right = pool->room[2 * position + 1];
+        pool->room[position] = left > right ? left : right;
+    }
+}
+
+// Sets the free memory of a node and updates the trees above its cpus
+// The positions above the cpus of the node are recomputed level by level, once each
+static void mempoolSetFree(MEMPOOL * pool, unsigned int node, unsigned long long free) {
+    pool->nodeFree[node] = free;
+
+    size_t first = pool->leaves + (size_t)node * pool->group;
+    size_t last = pool->leaves + ((size_t)(node + 1) * pool->group < pool->processors ? (size_t)(node + 1) * pool->group : pool->processors) - 1;
+    for (size_t position = first; position <= last; position++) {
+        pool->room[position] = free;
+    }
+
+    for (first /= 2, last /= 2; first > 0; first /= 2, last /= 2) {
+        for (size_t position = first; position <= last; position++) {
+            unsigned long long left = pool->room[2 * position], right = pool->room[2 * position + 1];
+            pool->room[position] = left > right ? left : right;
+        }
+    }
+}
+
+// Checks if a tree position comes before another one in the order of a placement
+// A position is keyed by the least remaining time below it, then by the first cpu below it
+static int mempoolBefore(MEMPOOL * pool, size_t a, size_t b) {
+    if (pool->loads[a] != pool->loads[b]) {
+        return pool->loads[a] < pool->loads[b];
+    }
+
+    // first leaf below each position
+    while (a < pool->leaves) {
+        a *= 2;
+    }
+    while (b < pool->leaves) {
+        b *= 2;
+    }
+    return a < b;
+}
+
+// Adds a tree position to the heap of a placement
+static void mempoolPush(MEMPOOL * pool, size_t * pCount, size_t position) {
+    size_t i = (*pCount)++;
+
+    while (i > 0 && mempoolBefore(pool, position, pool->heap[(i - 1) / 2])) {
+        pool->heap[i] = pool->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    pool->heap[i] = position;
+}
+
+// Takes the first tree position from the heap of a placement
+static size_t mempoolPop(MEMPOOL * pool, size_t * pCount) {
+    size_t first = pool->heap[0];
+    size_t last = pool->heap[--(*pCount)];
+    size_t i = 0;
+
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= *pCount) {
+            break;
+        }
+        if (child + 1 < *pCount && mempoolBefore(pool, pool->heap[child + 1], pool->heap[child])) {
+            child++;
+        }
+        if (!mempoolBefore(pool, pool->heap[child], last)) {
+            break;
+        }
+        pool->heap[i] = pool->heap[child];
+        i = child;
+    }
+    if (*pCount > 0) {
+        pool->heap[i] = last;
+    }
+
+    return first;
+}
@@ -0,0 +1,40 @@
+#ifndef MEMPOOL_H_
+#define MEMPOOL_H_
+
+// Include dependencies
+#include <stdlib.h>
+
+// Defines the memory capacity of the cpus.
+// Consecutive cpus are grouped in nodes that share one memory capacity (a node of one cpu gives
+// every cpu its own capacity). A sub process holds its memory on the node of its cpu from its
+// placement until its process finishes.
+// The cpus are the leaves of a tree holding the least remaining time and the most free memory
+// below each position. A placement walks the tree best first, skipping the subtrees without room
+// for the demand, and stops once it found its cpus. The remaining times are read once per tick,
+// then only on the cpus the placements of that tick went to.
+
+// Creates the memory pools of the cpus, group consecutive cpus sharing each capacity
+// Returns the pointer on success
+// Returns NULL if failed
+void * mempoolCreate(unsigned int processors, unsigned long long capacity, unsigned int group);
+
+// Deletes the memory pools
+void mempoolDelete(void * hPool);
+
+// Checks if k sub processes with the given demand each fit on the cpus when nothing is placed
+// Returns 1 if they fit
+// Returns 0 otherwise
+int mempoolFitsEmpty(void * hPool, unsigned long long demand, size_t k);
+
+// Selects the k cpus with the least remaining time whose node has room for the demand of one
+// more sub process, ties broken by the smaller id, and reserves the demand on each of them
+// Writes the ids of the selected cpus to ranked, from least to greatest remaining time
+// The sub processes are expected to be queued on those cpus before the next placement
+// Returns 1 on success
+// Returns 0 if the sub processes do not fit, reserving nothing
+int mempoolPlace(void * hPool, void * hProcessors, unsigned long long time, unsigned long long demand, size_t k, unsigned int * ranked);
+
+// Releases the demand of a sub process placed on a cpu
+void mempoolRelease(void * hPool, unsigned int cpu, unsigned long long demand);
+
+#endif
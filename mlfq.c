@@ -0,0 +1,274 @@
+#include "mlfq.h"
+#include "cpu.h"
+
+// Define struct for a queued sub process
+typedef struct MLFQNODE {
+    void * hSubProc;
+    unsigned int used; // ticks of the quantum already used at its level
+    unsigned int epoch; // boost epoch the quantum was used in
+    struct MLFQNODE * next;
+} MLFQNODE;
+
+// Define struct for a FIFO queue
+typedef struct {
+    MLFQNODE * head;
+    MLFQNODE * tail;
+} MLFQQUEUE;
+
+// Define struct for the queues of a processor
+typedef struct {
+    MLFQQUEUE queues[MLFQ_MAX_LEVELS];
+    unsigned int nonEmpty; // bit i is set when level i has a queued sub process
+    unsigned long long load; // remaining time of the queued sub processes
+    void * hSubProc; // sub process handed to the processor
+    unsigned int level; // level of that sub process
+    unsigned int used; // ticks of its quantum used before it was handed over
+    unsigned long long worked; // its worked time when it was handed over
+    unsigned int epoch; // boost epoch of the processor
+} MLFQCPU;
+
+// Define struct for the scheduler
+typedef struct {
+    unsigned int processors;
+    unsigned int levels;
+    unsigned int quanta[MLFQ_MAX_LEVELS];
+    unsigned int boost;
+    MLFQCPU * cpus;
+    MLFQNODE * freeNodes; // nodes ready for reuse
+} MLFQ;
+
+// Helper functions declaration
+
+// Adds a sub process to the front (front 1) or the back (front 0) of a level
+// Returns 1 on success
+// Returns 0 if failed
+static int mlfqQueue(MLFQ * mlfq, MLFQCPU * cpu, unsigned int level, int front, void * hSubProc, unsigned int used);
+
+// Moves every queued sub process to the highest level
+static void mlfqBoost(MLFQCPU * cpu);
+
+#define MLF(h) if (!h) { return 0; } MLFQ * mlfq = (MLFQ*)h;
+#define MLFN(h) if (!h) { return; } MLFQ * mlfq = (MLFQ*)h;
+
+// Creates the queues of the processors
+void * mlfqCreate(unsigned int processors, const unsigned int * quanta, unsigned int levels, unsigned int boost) {
+    if (levels == 0 || levels > MLFQ_MAX_LEVELS) {
+        return NULL;
+    }
+
+    MLFQ * mlfq = (MLFQ *)calloc(1, sizeof(MLFQ));
+    if (!mlfq) {
+        return NULL;
+    }
+
+    mlfq->cpus = (MLFQCPU *)calloc(processors, sizeof(MLFQCPU));
+    if (!mlfq->cpus) {
+        free(mlfq);
+        return NULL;
+    }
+
+    mlfq->processors = processors;
+    mlfq->levels = levels;
+    mlfq->boost = boost;
+    for (unsigned int i = 0; i < levels; i++) {
+        mlfq->quanta[i] = quanta[i] ? quanta[i] : 1;
+    }
+
+    return mlfq;
+}
+
+// Deletes the queues
+void mlfqDelete(void * hMlfq) {
+    MLFN(hMlfq)
+
+    for (unsigned int i = 0; i < mlfq->processors; i++) {
+        mlfqBoost(&mlfq->cpus[i]); // gather the nodes in a single queue
+        MLFQNODE * node = mlfq->cpus[i].queues[0].head;
+        while (node) {
+            MLFQNODE * next = node->next;
+            free(node);
+            node = next;
+        }
+    }
+
+    while (mlfq->freeNodes) {
+        MLFQNODE * next = mlfq->freeNodes->next;
+        free(mlfq->freeNodes);
+        mlfq->freeNodes = next;
+    }
+
+    free(mlfq->cpus);
+    free(mlfq);
+}
+
+// Queues a new sub process at the highest priority level of a processor
+int mlfqPush(void * hMlfq, unsigned int cpu, void * hSubProc) {
+    MLF(hMlfq)
+
+    if (cpu >= mlfq->processors) {
+        return 0;
+    }
+
+    return mlfqQueue(mlfq, &mlfq->cpus[cpu], 0, 0, hSubProc, 0);
+}
+
+// Gets the total remaining time of the sub processes queued on a processor
+unsigned long long mlfqLoad(void * hMlfq, unsigned int cpu) {
+    MLF(hMlfq)
+
+    return cpu < mlfq->processors ? mlfq->cpus[cpu].load : 0;
+}
+
+// Applies the time slicing of a processor at the start of a tick
+int mlfqDispatch(void * hMlfq, void * hProcessor, unsigned long long time) {
+    MLF(hMlfq)
+
+    unsigned int id = processorID(hProcessor);
+    if (id >= mlfq->processors) {
+        return 0;
+    }
+
+    MLFQCPU * cpu = &mlfq->cpus[id];
+    void * hCurrentSubProc = processorCurrentSubProc(hProcessor);
+
+    if (hCurrentSubProc != cpu->hSubProc) {
+        cpu->hSubProc = NULL; // dispatched sub process did not stay on the processor
+    }
+
+    if (hCurrentSubProc && subProcRem(hCurrentSubProc) == 0) {
+        hCurrentSubProc = NULL; // completed, the processor clears it on this step
+        cpu->hSubProc = NULL;
+    }
+
+    // the quantum is used by the ticks the sub process was worked on, switch costs excluded
+    unsigned int used = cpu->used;
+    if (cpu->hSubProc) {
+        used += (unsigned int)(subProcWorked(cpu->hSubProc) - cpu->worked); // at most the quantum
+    }
+
+    if (mlfq->boost && time > 0 && time % mlfq->boost == 0) {
+        mlfqBoost(cpu);
+        cpu->epoch++;
+        cpu->level = 0;
+        used = 0;
+    }
+
+    if (hCurrentSubProc) {
+        unsigned int level = cpu->level;
+
+        if (used >= mlfq->quanta[level]) {
+            // quantum expired, demote to the back of the next level
+            if (level + 1 < mlfq->levels) {
+                level++;
+            }
+            if (!mlfqQueue(mlfq, cpu, level, 0, hCurrentSubProc, 0)) {
+                return 0;
+            }
+        } else if (cpu->nonEmpty & ((1u << level) - 1)) {
+            // a higher level is waiting, keep the rest of the quantum at the front of the level
+            if (!mlfqQueue(mlfq, cpu, level, 1, hCurrentSubProc, used)) {
+                return 0;
+            }
+        } else {
+            // keeps running
+            cpu->used = used;
+            cpu->worked = subProcWorked(hCurrentSubProc);
+            return 1;
+        }
+    }
+
+    if (!cpu->nonEmpty) {
+        cpu->hSubProc = NULL;
+        return 1; // idle
+    }
+
+    // take the head of the highest non empty level
+    unsigned int level = (unsigned int)__builtin_ctz(cpu->nonEmpty);
+    MLFQQUEUE * queue = &cpu->queues[level];
+    MLFQNODE * node = queue->head;
+
+    queue->head = node->next;
+    if (!queue->head) {
+        queue->tail = NULL;
+        cpu->nonEmpty &= ~(1u << level);
+    }
+
+    cpu->hSubProc = node->hSubProc;
+    cpu->level = level;
+    cpu->used = node->epoch == cpu->epoch ? node->used : 0;
+    cpu->worked = subProcWorked(node->hSubProc);
+    cpu->load -= subProcRem(node->hSubProc);
+
+    node->next = mlfq->freeNodes;
+    mlfq->freeNodes = node;
+
+    if (cpu->hSubProc == hCurrentSubProc) {
+        return 1; // the only runnable sub process continues without a switch
+    }
+
+    if (hCurrentSubProc) {
+        processorClearCurrent(hProcessor);
+    }
+
+    return processorEnqueue(hProcessor, 0, cpu->hSubProc) != 0;
+}
+
+// helper function definitions
+
+// Adds a sub process to the front (front 1) or the back (front 0) of a level
+static int mlfqQueue(MLFQ * mlfq, MLFQCPU * cpu, unsigned int level, int front, void * hSubProc, unsigned int used) {
+    MLFQNODE * node = mlfq->freeNodes;
+
+    if (node) {
+        mlfq->freeNodes = node->next;
+    } else {
+        node = (MLFQNODE *)malloc(sizeof(MLFQNODE));
+        if (!node) {
+            return 0;
+        }
+    }
+
+    node->hSubProc = hSubProc;
+    node->used = used;
+    node->epoch = cpu->epoch;
+    node->next = NULL;
+
+    MLFQQUEUE * queue = &cpu->queues[level];
+    if (!queue->head) {
+        queue->head = queue->tail = node;
+    } else if (front) {
+        node->next = queue->head;
+        queue->head = node;
+    } else {
+        queue->tail->next = node;
+        queue->tail = node;
+    }
+
+    cpu->nonEmpty |= 1u << level;
+    cpu->load += subProcRem(hSubProc);
+
+    return 1;
+}
+
+// Moves every queued sub process to the highest level
+// The levels are appended in priority order, and the quanta used before the boost
+// are dropped lazily through the boost epoch of the nodes
+static void mlfqBoost(MLFQCPU * cpu) {
+    MLFQQUEUE * top = &cpu->queues[0];
+
+    while (cpu->nonEmpty & ~1u) {
+        unsigned int level = (unsigned int)__builtin_ctz(cpu->nonEmpty & ~1u);
+        MLFQQUEUE * queue = &cpu->queues[level];
+
+        if (top->head) {
+            top->tail->next = queue->head;
+        } else {
+            top->head = queue->head;
+        }
+        top->tail = queue->tail;
+
+        queue->head = queue->tail = NULL;
+        cpu->nonEmpty &= ~(1u << level);
+        cpu->nonEmpty |= 1u;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef MLFQ_H_
+#define MLFQ_H_
+
+// Include dependencies
+#include <stdlib.h>
+
+// Defines the multi-level feedback queues of the processors.
+// Every processor owns one FIFO queue per level. A sub process starts at level 0, runs for at most
+// the quantum of its level and is demoted to the next level when the quantum expires.
+// A sub process of a higher level preempts the running one, which keeps the rest of its quantum.
+// Every boost period all the sub processes go back to level 0 with a fresh quantum.
+// Each queue operation, including the boost, takes constant time.
+
+#define MLFQ_MAX_LEVELS 32
+
+// Creates the queues of the processors
+// quanta holds the time quantum of each level, from the highest priority to the lowest
+// boost is the period of the priority boost in ticks (0 disables it)
+// Returns the pointer on success
+// Returns NULL if failed
+void * mlfqCreate(unsigned int processors, const unsigned int * quanta, unsigned int levels, unsigned int boost);
+
+// Deletes the queues
+void mlfqDelete(void * hMlfq);
+
+// Queues a new sub process at the highest priority level of a processor
+// Returns 1 on success
+// Returns 0 if failed
+int mlfqPush(void * hMlfq, unsigned int cpu, void * hSubProc);
+
+// Gets the total remaining time of the sub processes queued on a processor
+unsigned long long mlfqLoad(void * hMlfq, unsigned int cpu);
+
+// Applies the time slicing of a processor at the start of a tick
+// Preempts the current sub process when its quantum expired or a higher level is waiting,
+// and hands the next sub process to the processor through the front of its pending list
+// Returns 1 on success
+// Returns 0 if failed
+int mlfqDispatch(void * hMlfq, void * hProcessor, unsigned long long time);
+
+#endif
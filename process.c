@@ -3,26 +3,50 @@
 
 // STRUCT DEFINITIONS
 typedef struct {
-    unsigned int arrival;
-    unsigned int exec;
+    unsigned long long arrival;
+    unsigned long long exec;
     unsigned int pid;
+    unsigned int outstanding; // sub processes that have not completed yet
+    unsigned long long completion; // latest completion time of the sub processes
     void * hSubProcesses; // list of sub process
+    void * hSuccessors; // processes that depend on this one (NULL if none)
+    unsigned int blockers; // predecessors that have not finished yet
+    unsigned long long priority; // scheduling priority (e.g. the length of the critical path)
+    unsigned long long memory; // memory demand of the process, shared by its sub processes
+    unsigned int tenant; // index of the tenant owning the process
+    unsigned int parallel; // the process is split into sub processes
 } PROCESS;
 
 typedef struct {
-    unsigned int exec;
+    unsigned long long exec;
     unsigned int pid;
-    unsigned int completion;
-    unsigned int worked;
+    unsigned long long completion;
+    unsigned long long worked;
+    unsigned long long lastRun; // last time frame the sub process was worked on
+    unsigned long long leftAt; // busy time of its cpu when it last left it
+    unsigned long long coldOwed; // cold cache ticks left unpaid by a preempted dispatch
     void * hProcess; // handle of the parent process
+    unsigned long long * phases; // alternating cpu and I/O burst lengths, starting with cpu (NULL for a single burst)
+    unsigned int phaseCount;
+    unsigned int phase; // index of the current burst
+    unsigned long long phaseWorked; // ticks of the current cpu burst already worked
+    unsigned long long wake; // time frame the current I/O burst completes
+    unsigned int cpu; // cpu the sub process was placed on
+    unsigned int placed; // the cpu was set
+    unsigned long long tag; // virtual finish time given by the fair share scheduler
 } SUBPROCESS;
 
+// Helper functions declaration
+
+// Accounts a completed sub process in its parent process
+static void subProcComplete(SUBPROCESS * subProc);
+
 // PROCESS DEFINITIONS
 #define PROC(h) if (!h) { return 0; } PROCESS* proc = (PROCESS*)h;
 #define PROCN(h) if (!h) { return; } PROCESS* proc = (PROCESS*)h;
 
 // Creates a handler to a process
-void * procCreate(unsigned int arrivalTime, unsigned int pid, unsigned int execTime, unsigned int canParallel, int processors) {
+void * procCreate(unsigned long long arrivalTime, unsigned int pid, unsigned long long execTime, unsigned int canParallel, int processors) {
     PROCESS* proc = (PROCESS*)calloc(1, sizeof(PROCESS));
 
     if (!proc) {
@@ -33,6 +57,7 @@ void * procCreate(unsigned int arrivalTime, unsigned int pid, unsigned int execT
     proc->arrival = arrivalTime;
     proc->pid = pid;
     proc->exec = execTime;
+    proc->parallel = canParallel != 0;
     proc->hSubProcesses = listCreate();
 
     if (!proc->hSubProcesses) {
@@ -43,14 +68,14 @@ void * procCreate(unsigned int arrivalTime, unsigned int pid, unsigned int execT
     void * hSubProc = NULL;
     if (canParallel) {
         unsigned int k = 0; // number of subProcesses
-        unsigned int subProcExecTime = 1; // for synchronization
+        unsigned long long subProcExecTime = 1; // for synchronization
 
         // compute the execution time 
-        if ((unsigned int)processors <= execTime) {
+        if ((unsigned long long)processors <= execTime) {
             k = processors;
-            subProcExecTime += (unsigned int)ceil((double)execTime / (double)processors);
+            subProcExecTime += (execTime + (unsigned long long)processors - 1) / (unsigned long long)processors; // exact ceiling
         } else {
-            k = execTime;
+            k = (unsigned int)execTime;
             subProcExecTime += 1;
         }
 
@@ -77,6 +102,14 @@ void * procCreate(unsigned int arrivalTime, unsigned int pid, unsigned int execT
         }
     }  
 
+    // a sub process without work is done as soon as it is dispatched
+    size_t count = listCount(proc->hSubProcesses);
+    for (size_t i = 0; i < count; i++) {
+        if (subProcExecTime(listGet(proc->hSubProcesses, i)) > 0) {
+            proc->outstanding++;
+        }
+    }
+
     return proc;
 }
 
@@ -91,17 +124,113 @@ void procDelete(void * hProcess) {
     }
     
     listDelete(proc->hSubProcesses);
+    listDelete(proc->hSuccessors);
     free(proc);
 }
 
+// Makes a process depend on a predecessor
+int procDepend(void * hProcess, void * hPredecessor) {
+    PROC(hProcess)
+
+    PROCESS * pred = (PROCESS *)hPredecessor;
+    if (!pred || pred == proc) {
+        return 0;
+    }
+
+    if (!pred->hSuccessors) {
+        pred->hSuccessors = listCreate();
+        if (!pred->hSuccessors) {
+            return 0;
+        }
+    }
+
+    if (listSearch(pred->hSuccessors, proc, NULL)) {
+        return 1; // already a successor
+    }
+
+    if (!listPush(pred->hSuccessors, proc)) {
+        return 0;
+    }
+
+    proc->blockers++;
+    return 1;
+}
+
+// Get the list of processes that depend on this one
+void * procSuccessors(void * hProcess) {
+    PROC(hProcess)
+
+    return proc->hSuccessors;
+}
+
+// Get the number of predecessors that have not finished
+unsigned int procBlockers(void * hProcess) {
+    PROC(hProcess)
+
+    return proc->blockers;
+}
+
+// Accounts a finished predecessor
+unsigned int procResolve(void * hProcess) {
+    PROC(hProcess)
+
+    if (proc->blockers > 0) {
+        proc->blockers--;
+    }
+
+    return proc->blockers;
+}
+
+// Get the scheduling priority
+unsigned long long procPriority(void * hProcess) {
+    PROC(hProcess)
+
+    return proc->priority;
+}
+
+// Set the scheduling priority
+void procSetPriority(void * hProcess, unsigned long long priority) {
+    PROCN(hProcess)
+
+    proc->priority = priority;
+}
+
+// Get the memory demand
+unsigned long long procMemory(void * hProcess) {
+    PROC(hProcess)
+
+    return proc->memory;
+}
+
+// Set the memory demand
+void procSetMemory(void * hProcess, unsigned long long memory) {
+    PROCN(hProcess)
+
+    proc->memory = memory;
+}
+
+// Get the tenant
+unsigned int procTenant(void * hProcess) {
+    PROC(hProcess)
+
+    return proc->tenant;
+}
+
+// Set the tenant
+void procSetTenant(void * hProcess, unsigned int tenant) {
+    PROCN(hProcess)
+
+    proc->tenant = tenant;
+}
+
 
 // Get remaining execution tim
 // returns the remaining time to complete
-unsigned int procRem(void * hProcess) {
+unsigned long long procRem(void * hProcess) {
     PROC(hProcess)
 
     size_t count = listCount(proc->hSubProcesses);
-    unsigned int rem = 0;
+    unsigned long long rem = 0;
 
     for (size_t i = 0; i < count; i++) {
         rem += subProcRem(listGet(proc->hSubProcesses, i));
@@ -110,8 +239,15 @@ unsigned int procRem(void * hProcess) {
     return rem;
 }
 
+// Get number of sub processes that have not completed
+unsigned int procOutstanding(void * hProcess) {
+    PROC(hProcess)
+
+    return proc->outstanding;
+}
+
 // Gets the arrival time of proc
-unsigned int procArrivalTime(void * hProcess) {
+unsigned long long procArrivalTime(void * hProcess) {
     PROC(hProcess)
 
     return proc->arrival;
@@ -125,31 +261,28 @@ unsigned int procID(void * hProcess) {
 }
 
 // Get turnaround time
-unsigned int procTAT(void * hProcess) {
+unsigned long long procTAT(void * hProcess) {
     PROC(hProcess)
 
-    size_t count = listCount(proc->hSubProcesses);
-
-    unsigned int completion = 0, subCompletion = 0;
-
-    for (size_t i = 0; i < count; i++) {
-        subCompletion = subProcCompletion(listGet(proc->hSubProcesses, i));
-
-        if (subCompletion > completion) {
-            completion = subCompletion;
-        }
-    }
-
-    return completion - proc->arrival + 1;
+    return proc->completion - proc->arrival + 1;
 }
 
 // Get exec time
-unsigned int procExecTime(void * hProcess) {
+unsigned long long procExecTime(void * hProcess) {
     PROC(hProcess)
 
     return proc->exec;
 }
 
+// Get the least work of a process on the cpus
+// The sizes of the sub processes add up to at least this, however they are split (see procCreate and -u)
+unsigned long long procWork(void * hProcess) {
+    PROC(hProcess)
+
+    unsigned long long subs = proc->parallel ? listCount(proc->hSubProcesses) : 0;
+    return subs > ~0ULL - proc->exec ? ~0ULL : proc->exec + subs;
+}
+
 // Get number of sub processes
 unsigned int procSubs(void * hProcess) {
     PROC(hProcess)
@@ -173,7 +306,7 @@ void * procSubsHandle(void * hProcess) {
 // Creates a handler to a subprocess
 // Returns the pointer to the subprocess
 // Returns NULL if failed
-void * subProcCreate(unsigned int pid, unsigned int execTime, void * hProcess) {
+void * subProcCreate(unsigned int pid, unsigned long long execTime, void * hProcess) {
     if (!hProcess) { // there should be a parent process to the sub process
         return NULL;
     }
@@ -198,18 +331,112 @@ void * subProcCreate(unsigned int pid, unsigned int execTime, void * hProcess) {
 void subProcDelete(void * hSubProc) {
     SUBPROCN(hSubProc);
 
+    free(subProc->phases);
     free(subProc);
 }
 
+// Records that a sub process left its cpu before completing
+void subProcLeave(void * hSubProc, unsigned long long busyTime, unsigned long long coldOwed) {
+    SUBPROCN(hSubProc)
+
+    subProc->leftAt = busyTime;
+    subProc->coldOwed = coldOwed;
+}
+
+// Get the busy time of its cpu when the sub process last left it
+unsigned long long subProcLeftAt(void * hSubProc) {
+    SUBPROC(hSubProc)
+
+    return subProc->leftAt;
+}
+
+// Get the cold cache ticks the sub process still owes
+unsigned long long subProcColdOwed(void * hSubProc) {
+    SUBPROC(hSubProc)
+
+    return subProc->coldOwed;
+}
+
+// Sets the cpu and I/O bursts of a sub process that has not run yet
+int subProcSetPhases(void * hSubProc, const unsigned long long * phases, unsigned int count) {
+    SUBPROC(hSubProc)
+
+    // a process is not finished before its last I/O completed, so the bursts end with a cpu burst
+    if (subProc->worked > 0 || count % 2 == 0) {
+        return 0;
+    }
+
+    unsigned long long * copy = (unsigned long long *)malloc(count * sizeof(unsigned long long));
+    if (!copy) {
+        return 0;
+    }
+
+    unsigned long long exec = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        if (phases[i] == 0) {
+            free(copy);
+            return 0; // empty burst
+        }
+        copy[i] = phases[i];
+        if (i % 2 == 0) {
+            exec += phases[i];
+        }
+    }
+
+    free(subProc->phases);
+    subProc->phases = copy;
+    subProc->phaseCount = count;
+    subProc->phase = 0;
+    subProc->phaseWorked = 0;
+    subProc->exec = exec;
+
+    return 1;
+}
+
+// Get the length of the I/O burst the sub process is waiting on
+unsigned long long subProcIOTime(void * hSubProc) {
+    SUBPROC(hSubProc)
+
+    if (!subProc->phases || subProc->phase % 2 == 0 || subProc->phase >= subProc->phaseCount) {
+        return 0;
+    }
+
+    return subProc->phases[subProc->phase];
+}
+
+// Blocks the sub process on its I/O burst until the given time frame
+void subProcBlock(void * hSubProc, unsigned long long wake) {
+    SUBPROCN(hSubProc)
+
+    subProc->wake = wake;
+}
+
+// Get the time frame the I/O burst of a blocked sub process completes
+unsigned long long subProcWakeTime(void * hSubProc) {
+    SUBPROC(hSubProc)
+
+    return subProc->wake;
+}
+
+// Completes the I/O burst of a blocked sub process
+void subProcWake(void * hSubProc) {
+    SUBPROCN(hSubProc)
+
+    if (subProcIOTime(subProc) > 0) {
+        subProc->phase++;
+        subProc->phaseWorked = 0;
+    }
+}
+
 // Completion time
-unsigned int subProcCompletion(void * hSubProc) {
+unsigned long long subProcCompletion(void * hSubProc) {
     SUBPROC(hSubProc)
 
     return subProc->completion;
 }
 
 // Execution time
-unsigned int subProcExecTime(void * hSubProc) {
+unsigned long long subProcExecTime(void * hSubProc) {
     SUBPROC(hSubProc)
 
     return subProc->exec;
@@ -223,23 +450,32 @@ void * subProcParent(void * hSubProc) {
 }
 
 // Get worked 
-unsigned int subProcWorked(void * hSubProc) {
+unsigned long long subProcWorked(void * hSubProc) {
     SUBPROC(hSubProc)
 
     return subProc->worked;
 }
 
 // Runs a single step of a sub process
-// Returns 1 if finished
+// Returns 1 if finished after this step
 // Returns 0 otherwise
-unsigned int subProcExec(void * hSubProc, unsigned int timeFrame) {
+unsigned int subProcExec(void * hSubProc, unsigned long long timeFrame) {
     SUBPROC(hSubProc)
 
     if (subProc->worked < subProc->exec) {
         subProc->worked++;
+        subProc->lastRun = timeFrame;
+
+        // move on to the next burst once the cpu burst is done
+        if (subProc->phases && ++subProc->phaseWorked == subProc->phases[subProc->phase]) {
+            subProc->phase++;
+            subProc->phaseWorked = 0;
+        }
 
         if (subProc->worked == subProc->exec) {
             subProc->completion = timeFrame;
+            subProcComplete(subProc);
+            return 1;
         }
         return 0;
     } else {
@@ -247,6 +483,58 @@ unsigned int subProcExec(void * hSubProc, unsigned int timeFrame) {
     }
 }
 
+// Changes the execution time of a sub process that has not run yet
+void subProcResize(void * hSubProc, unsigned long long execTime) {
+    SUBPROCN(hSubProc)
+
+    if (subProc->worked == 0 && subProc->exec > 0 && execTime > 0) {
+        subProc->exec = execTime;
+    }
+}
+
+// Get the last time frame the sub process was worked on
+unsigned long long subProcLastRun(void * hSubProc) {
+    SUBPROC(hSubProc)
+
+    return subProc->lastRun;
+}
+
+// Get the cpu the sub process was placed on
+unsigned int subProcCPU(void * hSubProc) {
+    SUBPROC(hSubProc)
+
+    return subProc->cpu;
+}
+
+// Set the cpu the sub process was placed on
+void subProcSetCPU(void * hSubProc, unsigned int cpu) {
+    SUBPROCN(hSubProc)
+
+    subProc->cpu = cpu;
+    subProc->placed = 1;
+}
+
+// Check if the sub process was placed on a cpu
+int subProcPlaced(void * hSubProc) {
+    SUBPROC(hSubProc)
+
+    return subProc->placed != 0;
+}
+
+// Get the virtual finish time
+unsigned long long subProcTag(void * hSubProc) {
+    SUBPROC(hSubProc)
+
+    return subProc->tag;
+}
+
+// Set the virtual finish time
+void subProcSetTag(void * hSubProc, unsigned long long tag) {
+    SUBPROCN(hSubProc)
+
+    subProc->tag = tag;
+}
+
 // Get id
 unsigned int subProcID(void * hSubProc) {
     SUBPROC(hSubProc)
@@ -255,15 +543,39 @@ unsigned int subProcID(void * hSubProc) {
 }
 
 // Get remaining time
-unsigned int subProcRem(void * hSubProc) {
+unsigned long long subProcRem(void * hSubProc) {
     SUBPROC(hSubProc)
 
     return subProc->exec - subProc->worked;
 }
 
 // Get waiting time of the sub process
-unsigned int subProcWaiting(void * hSubProc, unsigned int time) {
+unsigned long long subProcWaiting(void * hSubProc, unsigned long long time) {
     SUBPROC(hSubProc)
 
-    return time - procArrivalTime(subProcParent(subProc->hProcess)) - subProc->worked;
+    return time - procArrivalTime(subProc->hProcess) - subProc->worked;
+}
+
+// Restores the progress of a sub process from a snapshot
+void subProcRestore(void * hSubProc, unsigned long long worked, unsigned long long completion) {
+    SUBPROCN(hSubProc)
+
+    subProc->worked = worked;
+    subProc->completion = completion;
+
+    if (subProc->exec > 0 && subProc->worked == subProc->exec) {
+        subProcComplete(subProc);
+    }
+}
+
+// helper function definitions
+
+// Accounts a completed sub process in its parent process
+static void subProcComplete(SUBPROCESS * subProc) {
+    PROCESS * proc = (PROCESS *)subProc->hProcess;
+
+    proc->outstanding--;
+    if (subProc->completion > proc->completion) {
+        proc->completion = subProc->completion;
+    }
 }
\ No newline at end of file
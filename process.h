@@ -12,8 +12,8 @@
 // Creates a handler to a process
 // Returns handler to the process
 // Returns NULL if failed
-void * procCreate(unsigned int arrivalTime, 
-                  unsigned int pid, unsigned int execTime, 
+void * procCreate(unsigned long long arrivalTime, 
+                  unsigned int pid, unsigned long long execTime, 
                   unsigned int canParallel, 
                   int processors);
 
@@ -24,60 +24,160 @@ void procDelete(void * hProcess);
 
 // Get remaining execution tim
 // returns the remaining time to complete
-unsigned int procRem(void * hProcess);
+unsigned long long procRem(void * hProcess);
+
+// Get number of sub processes that have not completed
+// returns 0 once the process is finished
+unsigned int procOutstanding(void * hProcess);
 
 // Get the arrival time of process
-unsigned int procArrivalTime(void * hProcess);
+unsigned long long procArrivalTime(void * hProcess);
 
 // Get pid of process
 unsigned int procID(void * hProcess);
 
 // Get turnaround time
-unsigned int procTAT(void * hProcess);
+unsigned long long procTAT(void * hProcess);
 
 // Get exec time
-unsigned int procExecTime(void * hProcess);
+unsigned long long procExecTime(void * hProcess);
 
 // Get number of sub processes
 unsigned int procSubs(void * hProcess);
 
+// Get the least work of a process on the cpus: its execution time, plus one tick of synchronisation
+// per sub process when it is split
+unsigned long long procWork(void * hProcess);
+
 // Get handle of the subprocesses
 void * procSubsHandle(void * hProcess);
 
+// Makes a process depend on a predecessor: it is only released once the predecessor finished
+// Returns 1 on success
+// Returns 0 if failed
+int procDepend(void * hProcess, void * hPredecessor);
+
+// Get the list of processes that depend on this one
+// Returns NULL if none does
+void * procSuccessors(void * hProcess);
+
+// Get the number of predecessors that have not finished
+unsigned int procBlockers(void * hProcess);
+
+// Accounts a finished predecessor
+// Returns the number of predecessors that have not finished
+unsigned int procResolve(void * hProcess);
+
+// Get the scheduling priority (0 unless set)
+unsigned long long procPriority(void * hProcess);
+
+// Set the scheduling priority
+void procSetPriority(void * hProcess, unsigned long long priority);
+
+// Get the memory demand (0 unless set)
+unsigned long long procMemory(void * hProcess);
+
+// Set the memory demand, shared evenly by the sub processes
+void procSetMemory(void * hProcess, unsigned long long memory);
+
+// Get the index of the tenant owning the process (0 unless set)
+unsigned int procTenant(void * hProcess);
+
+// Set the index of the tenant owning the process
+void procSetTenant(void * hProcess, unsigned int tenant);
+
 // SUBPROCESS FUNCTIONS
 
 // Creates a handler to a subprocess
 // Returns the pointer to the subprocess
 // Returns NULL if failed
-void * subProcCreate(unsigned int pid, unsigned int execTime, void * hProcess);
+void * subProcCreate(unsigned int pid, unsigned long long execTime, void * hProcess);
 
 // Deletes the handler of a sub process
 void subProcDelete(void * hSubProc);
 
 // Runs a single step of a sub process
-// Returns 1 if finished
+// Returns 1 if finished after this step
 // Returns 0 otherwise
-unsigned int subProcExec(void * hSubProc, unsigned int timeFrame);
+unsigned int subProcExec(void * hSubProc, unsigned long long timeFrame);
 
 // Execution time
-unsigned int subProcExecTime(void * hSubProc);
+unsigned long long subProcExecTime(void * hSubProc);
 
 // Completion time
-unsigned int subProcCompletion(void * hSubProc);
+unsigned long long subProcCompletion(void * hSubProc);
 
 // Parent process
 void * subProcParent(void * hSubProc);
 
 // Get worked 
-unsigned int subProcWorked(void * hSubProc);
+unsigned long long subProcWorked(void * hSubProc);
+
+// Changes the execution time of a sub process that has not run yet
+// (used to size the sub processes of a parallel process once their cpus are known)
+void subProcResize(void * hSubProc, unsigned long long execTime);
+
+// Sets the cpu and I/O bursts of a sub process that has not run yet
+// phases alternates cpu and I/O burst lengths, starting and ending with a cpu burst (count is odd);
+// the execution time becomes the sum of the cpu bursts
+// Returns 1 on success
+// Returns 0 if a burst is empty, the last burst is an I/O burst or failed
+int subProcSetPhases(void * hSubProc, const unsigned long long * phases, unsigned int count);
+
+// Get the length of the I/O burst the sub process is waiting on
+// Returns 0 while the sub process is in a cpu burst
+unsigned long long subProcIOTime(void * hSubProc);
+
+// Blocks the sub process on its I/O burst until the given time frame
+void subProcBlock(void * hSubProc, unsigned long long wake);
+
+// Get the time frame the I/O burst of a blocked sub process completes
+unsigned long long subProcWakeTime(void * hSubProc);
+
+// Completes the I/O burst of a blocked sub process
+void subProcWake(void * hSubProc);
+
+// Get the last time frame the sub process was worked on (0 if it never ran)
+unsigned long long subProcLastRun(void * hSubProc);
+
+// Records that a sub process left its cpu before completing, with the busy time of the cpu at that
+// point and the cold cache ticks it still owes
+void subProcLeave(void * hSubProc, unsigned long long busyTime, unsigned long long coldOwed);
+
+// Get the busy time of its cpu when the sub process last left it
+unsigned long long subProcLeftAt(void * hSubProc);
+
+// Get the cold cache ticks the sub process still owes from a dispatch that was preempted
+unsigned long long subProcColdOwed(void * hSubProc);
+
+// Get the cpu the sub process was placed on (0 unless set)
+unsigned int subProcCPU(void * hSubProc);
+
+// Set the cpu the sub process was placed on
+void subProcSetCPU(void * hSubProc, unsigned int cpu);
+
+// Check if the sub process was placed on a cpu (queued on a processor or its feedback queues)
+// Returns 1 if it was
+// Returns 0 otherwise
+int subProcPlaced(void * hSubProc);
+
+// Get the virtual finish time given by the fair share scheduler (0 unless set)
+unsigned long long subProcTag(void * hSubProc);
+
+// Set the virtual finish time given by the fair share scheduler
+void subProcSetTag(void * hSubProc, unsigned long long tag);
 
 // Get id
 unsigned int subProcID(void * hSubProc);
 
 // Get remaining time
-unsigned int subProcRem(void * hSubProc);
+unsigned long long subProcRem(void * hSubProc);
 
 // Get waiting time of the sub process
-unsigned int subProcWaiting(void * hSubProc, unsigned int time);
+unsigned long long subProcWaiting(void * hSubProc, unsigned long long time);
+
+// Restores the progress of a sub process from a snapshot
+// (must be called once per sub process of a freshly created process)
+void subProcRestore(void * hSubProc, unsigned long long worked, unsigned long long completion);
 
 #endif
\ No newline at end of file
@@ -5,8 +5,37 @@ typedef struct {
     unsigned int cpuID;
     void * hListPending; // list of pending sub processes assigned to this processor
     void * hCurrentSubProc; // the current sub process being executed
+    void * hListBlocked; // sub processes waiting on an I/O burst, by wake time
+    unsigned long long blockedRem; // remaining time of the blocked sub processes
+    unsigned long long busyTime; // ticks a sub process was worked on
+    unsigned long long overlapTime; // ticks worked while another sub process of the processor was blocked
+    // running sums over the pending sub processes, so that the remaining and waiting
+    // times are computed in constant time (a pending sub process is never worked)
+    unsigned long long sumArrival; // arrival time of the parent processes
+    unsigned long long sumExec; // execution time
+    unsigned long long sumWorked; // time already worked
+    // context switch and cold cache costs, in ticks
+    unsigned int switchCost; // cost of switching to another sub process
+    unsigned int coldWindow; // one tick of cold cache penalty per window ticks descheduled (0 disables it)
+    unsigned int coldMax; // maximum cold cache penalty (0 for no limit)
+    unsigned int stallSwitch; // switch ticks left before the current sub process runs
+    unsigned long long stallCold; // cold cache ticks left before the current sub process runs
+    unsigned int announce; // the current sub process is reported as running when it first runs
+    unsigned int hold; // the pending sub processes are not dispatched on this step
+    void * hLastRun; // the last sub process worked on by this processor
+    unsigned int switches; // number of context switches
+    unsigned long long switchTime; // ticks lost to context switches
+    unsigned long long coldTime; // ticks lost to cold caches
 } PROCESSOR;
 
+// Helper functions declaration
+
+// Adds (sign 1) or removes (sign -1) a sub process from the running sums
+static void processorAccount(PROCESSOR * pcr, void * hSubProc, int sign);
+
+// Charges the switch and cold cache costs of dispatching a sub process
+static void processorCharge(PROCESSOR * pcr, void * hSubProc);
+
 // PROCESSOR FUNCTIONS
 #define PCR(h) if (!h) { return 0; } PROCESSOR* pcr = (PROCESSOR*)h;
 #define PCRN(h) if (!h) { return; } PROCESSOR* pcr = (PROCESSOR*)h;
@@ -23,8 +52,9 @@ void * processorCreate(unsigned int cpuID) {
 
     p->cpuID = cpuID;
     p->hListPending = listCreate();
+    p->hListBlocked = listCreate();
 
-    if (!p->hListPending) {
+    if (!p->hListPending || !p->hListBlocked) {
         processorDelete(p);
         return NULL;
     }
@@ -39,11 +69,13 @@ void processorDelete(void * hProcessor) {
     PCRN(hProcessor)
 
     listDelete(pcr->hListPending);
+    listDelete(pcr->hListBlocked);
     free(pcr);
 }
 
 // Performs a single step of the processor
-void processorRun(void * hProcessor, unsigned int timeFrame, void * hRunningSubProcs) {
+// The parent of a sub process that completes on this step is added to hCompletedProcs
+void processorRun(void * hProcessor, unsigned long long timeFrame, void * hRunningSubProcs, void * hCompletedProcs) {
     PCRN(hProcessor)
 
     // Check if current sub process is finished
@@ -53,19 +85,70 @@ void processorRun(void * hProcessor, unsigned int timeFrame, void * hRunningSubP
         }
     } 
 
-    if (pcr->hCurrentSubProc) {
-        // run current sub process
-        subProcExec(pcr->hCurrentSubProc, timeFrame);
-    } else {
+    void * hExecuted = NULL;
+
+    if (!pcr->hCurrentSubProc && !pcr->hold) {
         // FIFO - get the first pending sub process
         size_t count = listCount(pcr->hListPending);
         
         if (count > 0) {       
             pcr->hCurrentSubProc = listRemove(pcr->hListPending, 0); // remove from pending list
-            subProcExec(pcr->hCurrentSubProc, timeFrame); // execute new sub process
-            listSet(hRunningSubProcs, pcr->cpuID, pcr->hCurrentSubProc);
+            processorAccount(pcr, pcr->hCurrentSubProc, -1);
+            processorCharge(pcr, pcr->hCurrentSubProc);
+            pcr->announce = 1;
         } 
     }
+
+    if (pcr->hCurrentSubProc) {
+        if (pcr->stallSwitch > 0) { // still switching
+            pcr->stallSwitch--;
+            pcr->switchTime++;
+        } else if (pcr->stallCold > 0) { // still warming the cache
+            pcr->stallCold--;
+            pcr->coldTime++;
+        } else {
+            // run current sub process
+            if (subProcExec(pcr->hCurrentSubProc, timeFrame)) {
+                hExecuted = pcr->hCurrentSubProc;
+            }
+            pcr->hLastRun = pcr->hCurrentSubProc;
+            pcr->busyTime++;
+            if (listCount(pcr->hListBlocked) > 0) {
+                pcr->overlapTime++; // the cpu works while another sub process waits on I/O
+            }
+
+            if (pcr->announce) { // first step since it was dispatched
+                listSet(hRunningSubProcs, pcr->cpuID, pcr->hCurrentSubProc);
+                pcr->announce = 0;
+            }
+
+            // a finished cpu burst blocks the sub process on its I/O burst
+            unsigned long long ioTime = hExecuted ? 0 : subProcIOTime(pcr->hCurrentSubProc);
+            if (ioTime > 0) {
+                void * hBlocked = pcr->hCurrentSubProc;
+                unsigned long long wake = timeFrame + ioTime + 1;
+                size_t count = listCount(pcr->hListBlocked), insert = count;
+                while (insert > 0 && subProcWakeTime(listGet(pcr->hListBlocked, insert - 1)) > wake) {
+                    insert--;
+                }
+
+                subProcBlock(hBlocked, wake);
+                subProcLeave(hBlocked, pcr->busyTime, 0);
+                if (listInsert(pcr->hListBlocked, insert, hBlocked)) {
+                    pcr->blockedRem += subProcRem(hBlocked);
+                    pcr->hCurrentSubProc = NULL;
+                }
+            }
+        }
+    }
+
+    // report the parent of a completed sub process
+    if (hExecuted) {
+        void * hParent = subProcParent(hExecuted);
+        if (!listSearch(hCompletedProcs, hParent, NULL)) {
+            listPush(hCompletedProcs, hParent);
+        }
+    }
 }
 
 // Returns the list of pending processes
@@ -75,25 +158,98 @@ void * processorPending(void * hProcessor) {
     return pcr->hListPending;
 }
 
-// Calculates the total remaining time of the pending sub processes
-unsigned int processorRemainingTime(void * hProcessor) {
+// Inserts a sub process to the pending list at the given index
+// Returns the number of pending sub processes after insertion
+// Returns 0 if failed
+size_t processorEnqueue(void * hProcessor, size_t index, void * hSubProc) {
     PCR(hProcessor)
 
-    int remTime = 0;
+    size_t count = listInsert(pcr->hListPending, index, hSubProc);
+    if (count) {
+        processorAccount(pcr, hSubProc, 1);
+        subProcSetCPU(hSubProc, pcr->cpuID);
+    }
+
+    return count;
+}
 
-    if (pcr->hCurrentSubProc) {
-        remTime += subProcRem(pcr->hCurrentSubProc);
+// Moves the sub processes whose I/O burst completed by the given time to hWokenSubProcs
+size_t processorWake(void * hProcessor, unsigned long long time, void * hWokenSubProcs) {
+    PCR(hProcessor)
+
+    size_t woken = 0;
+    while (listCount(pcr->hListBlocked) > 0 && subProcWakeTime(listGet(pcr->hListBlocked, 0)) <= time) {
+        void * hSubProc = listRemove(pcr->hListBlocked, 0);
+        pcr->blockedRem -= subProcRem(hSubProc);
+        subProcWake(hSubProc);
+        listPush(hWokenSubProcs, hSubProc);
+        woken++;
     }
 
-    size_t count = listCount(pcr->hListPending);
+    return woken;
+}
 
-    for (size_t i = 0; i < count; i++) {
-        remTime += subProcRem(listGet(pcr->hListPending, i));
+// Gets the tick the first blocked sub process wakes up on
+// The blocked list is kept by wake time
+unsigned long long processorNextWake(void * hProcessor) {
+    PCR(hProcessor)
+
+    return listCount(pcr->hListBlocked) > 0 ? subProcWakeTime(listGet(pcr->hListBlocked, 0)) : ~0ULL;
+}
+
+// Gets the ticks a sub process was worked on
+unsigned long long processorBusyTime(void * hProcessor) {
+    PCR(hProcessor)
+
+    return pcr->busyTime;
+}
+
+// Gets the ticks worked while another sub process of the processor was blocked on I/O
+unsigned long long processorOverlapTime(void * hProcessor) {
+    PCR(hProcessor)
+
+    return pcr->overlapTime;
+}
+
+// Removes the pending sub process at the given index
+// Returns the removed sub process
+// Returns NULL if failed
+void * processorDequeue(void * hProcessor, size_t index) {
+    PCR(hProcessor)
+
+    void * hSubProc = listRemove(pcr->hListPending, index);
+    if (hSubProc) {
+        processorAccount(pcr, hSubProc, -1);
+    }
+
+    return hSubProc;
+}
+
+// Calculates the total remaining time of the pending sub processes
+unsigned long long processorRemainingTime(void * hProcessor) {
+    PCR(hProcessor)
+
+    unsigned long long remTime = pcr->sumExec - pcr->sumWorked + pcr->blockedRem;
+
+    if (pcr->hCurrentSubProc) {
+        remTime += subProcRem(pcr->hCurrentSubProc) + pcr->stallSwitch + pcr->stallCold;
     }
 
     return remTime;
 }
 
+// Calculates the total waiting time of the pending sub processes
+unsigned long long processorWaiting(void * hProcessor, unsigned long long time) {
+    PCR(hProcessor)
+
+    // each pending sub process arrived and worked before the given time, so its waiting time is
+    // not negative and the difference of the sums is exact even when the sums wrap around
+    unsigned long long elapsed = (unsigned long long)listCount(pcr->hListPending) * time;
+    unsigned long long spent = pcr->sumArrival + pcr->sumWorked;
+
+    return elapsed - spent;
+}
+
 void * processorCurrentSubProc(void * hProcessor) {
     PCR(hProcessor)
 
@@ -110,14 +266,67 @@ unsigned int processorID(void * hProcessor) {
 void processorClearCurrent(void * hProcessor) {
     PCRN(hProcessor)
 
+    // a preempted dispatch loses its remaining switch cost, the sub process keeps owing its cold cache ticks
+    if (pcr->hCurrentSubProc && subProcRem(pcr->hCurrentSubProc) > 0) {
+        subProcLeave(pcr->hCurrentSubProc, pcr->busyTime, pcr->stallCold);
+    }
+
     pcr->hCurrentSubProc = NULL;
+    pcr->stallSwitch = 0;
+    pcr->stallCold = 0;
+    pcr->announce = 0;
+}
+
+// Set current sub proc (used when restoring a snapshot)
+void processorSetCurrent(void * hProcessor, void * hSubProc) {
+    PCRN(hProcessor)
+
+    pcr->hCurrentSubProc = hSubProc;
+}
+
+// Keeps (hold 1) or lets (hold 0) the processor dispatch a pending sub process when it is idle
+void processorHold(void * hProcessor, unsigned int hold) {
+    PCRN(hProcessor)
+
+    pcr->hold = hold;
+}
+
+// Sets the context switch and cold cache costs
+void processorSetCosts(void * hProcessor, unsigned int switchCost, unsigned int coldWindow, unsigned int coldMax) {
+    PCRN(hProcessor)
+
+    pcr->switchCost = switchCost;
+    pcr->coldWindow = coldWindow;
+    pcr->coldMax = coldMax;
+}
+
+// Gets the number of context switches
+unsigned int processorSwitches(void * hProcessor) {
+    PCR(hProcessor)
+
+    return pcr->switches;
+}
+
+// Gets the ticks lost to context switches
+unsigned long long processorSwitchTime(void * hProcessor) {
+    PCR(hProcessor)
+
+    return pcr->switchTime;
+}
+
+// Gets the ticks lost to cold caches
+unsigned long long processorColdTime(void * hProcessor) {
+    PCR(hProcessor)
+
+    return pcr->coldTime;
 }
 
 // Gets the nearest deadline of the processor
-unsigned int processorDeadline(void * hProcessor) {
+unsigned long long processorDeadline(void * hProcessor) {
     PCR(hProcessor);
 
-    unsigned int nearestDeadline = 0, found = 0;
+    unsigned long long nearestDeadline = 0;
+    unsigned int found = 0;
 
     if (pcr->hCurrentSubProc) {
         nearestDeadline = procArrivalTime(subProcParent(pcr->hCurrentSubProc)) + subProcExecTime(pcr->hCurrentSubProc);
@@ -127,7 +336,7 @@ unsigned int processorDeadline(void * hProcessor) {
     size_t count = listCount(pcr->hListPending);
     for (size_t i = 0; i < count; i++) {
         void * hSubProc = listGet(pcr->hListPending, i);
-        unsigned deadline = procArrivalTime(subProcParent(hSubProc)) + subProcExecTime(hSubProc);
+        unsigned long long deadline = procArrivalTime(subProcParent(hSubProc)) + subProcExecTime(hSubProc);
         if (found) {
             if (deadline > nearestDeadline) { // the deadline of the processor is the longest one
                 nearestDeadline = deadline;
@@ -139,4 +348,47 @@ unsigned int processorDeadline(void * hProcessor) {
     }
 
     return nearestDeadline;
+}
+
+// helper function definitions
+
+// Charges the switch and cold cache costs of dispatching a sub process
+// Switching back to the last sub process that ran is free, a sub process that already ran
+// pays the cold cache ticks it still owes plus one tick per cold window the processor worked on
+// other sub processes since it left (switch, cold cache and idle ticks do not evict its cache)
+static void processorCharge(PROCESSOR * pcr, void * hSubProc) {
+    pcr->stallSwitch = 0;
+    pcr->stallCold = 0;
+
+    if (hSubProc == pcr->hLastRun) {
+        return;
+    }
+
+    pcr->switches++;
+    pcr->stallSwitch = pcr->switchCost;
+
+    if (pcr->coldWindow && subProcWorked(hSubProc) > 0) {
+        unsigned long long away = pcr->busyTime - subProcLeftAt(hSubProc);
+        pcr->stallCold = subProcColdOwed(hSubProc) + away / pcr->coldWindow;
+        if (pcr->coldMax && pcr->stallCold > pcr->coldMax) {
+            pcr->stallCold = pcr->coldMax;
+        }
+    }
+}
+
+// Adds (sign 1) or removes (sign -1) a sub process from the running sums
+static void processorAccount(PROCESSOR * pcr, void * hSubProc, int sign) {
+    unsigned long long arrival = procArrivalTime(subProcParent(hSubProc));
+    unsigned long long exec = subProcExecTime(hSubProc);
+    unsigned long long worked = subProcWorked(hSubProc);
+
+    if (sign > 0) {
+        pcr->sumArrival += arrival;
+        pcr->sumExec += exec;
+        pcr->sumWorked += worked;
+    } else {
+        pcr->sumArrival -= arrival;
+        pcr->sumExec -= exec;
+        pcr->sumWorked -= worked;
+    }
 }
\ No newline at end of file
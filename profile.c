@@ -0,0 +1,72 @@
+#include "profile.h"
+
+#ifdef PROFILE
+
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILE_UNIT "cycles"
+#else
+#define PROFILE_UNIT "ns"
+#endif
+
+// Define struct for the profiler
+typedef struct {
+    unsigned long long calls[PROF_PHASES];
+    unsigned long long ticks[PROF_PHASES];
+} PROFILE_INFO;
+
+static const char * phaseNames[PROF_PHASES] = {
+    "arrivals",
+    "ranking",
+    "pending",
+    "processorRun",
+    "output",
+    "cpuStats"
+};
+
+#define PRF(h) if (!h) { return; } PROFILE_INFO * prf = (PROFILE_INFO*)h;
+
+// Creates a profiler
+void * profileCreate() {
+    return calloc(1, sizeof(PROFILE_INFO));
+}
+
+// Deletes a profiler
+void profileDelete(void * hProfile) {
+    free(hProfile);
+}
+
+// Reads the timestamp counter
+unsigned long long profileNow() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+#endif
+}
+
+// Adds a timed call to a phase
+void profileAdd(void * hProfile, PROFPHASE phase, unsigned long long ticks) {
+    PRF(hProfile)
+
+    prf->calls[phase]++;
+    prf->ticks[phase] += ticks;
+}
+
+// Writes the call counts and total/mean ticks of each phase
+void profileReport(void * hProfile, FILE * hFile) {
+    PRF(hProfile)
+
+    fprintf(hFile, "%-14s %12s %16s %12s\n", "phase", "calls", "total " PROFILE_UNIT, "mean");
+    for (int i = 0; i < PROF_PHASES; i++) {
+        double mean = prf->calls[i] ? (double)prf->ticks[i] / (double)prf->calls[i] : 0.0;
+        fprintf(hFile, "%-14s %12llu %16llu %12.1f\n", phaseNames[i], prf->calls[i], prf->ticks[i], mean);
+    }
+}
+
+#endif
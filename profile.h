@@ -0,0 +1,50 @@
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stdio.h>
+
+// Optional self-profiling of the simulator phases.
+// The timers are only compiled in when PROFILE is defined (make PROFILE=1),
+// otherwise every macro below expands to nothing.
+
+// Phases of the simulator that are timed
+typedef enum {
+    PROF_ARRIVALS = 0,  // discovery of the arriving processes
+    PROF_RANKING,       // ranking of the cpus for an arriving process
+    PROF_PENDING,       // insertion of sub processes to the pending queues
+    PROF_PROCESSOR_RUN, // single step of a processor
+    PROF_OUTPUT,        // emission of the RUNNING/FINISHED events
+    PROF_STATS,         // computation of the statistics
+    PROF_PHASES
+} PROFPHASE;
+
+#ifdef PROFILE
+
+// Creates a profiler
+// Returns the pointer on success
+// Returns NULL if failed
+void * profileCreate();
+
+// Deletes a profiler
+void profileDelete(void * hProfile);
+
+// Reads the timestamp counter (cycles on x86, nanoseconds otherwise)
+unsigned long long profileNow();
+
+// Adds a timed call to a phase
+void profileAdd(void * hProfile, PROFPHASE phase, unsigned long long ticks);
+
+// Writes the call counts and total/mean ticks of each phase
+void profileReport(void * hProfile, FILE * hFile);
+
+#define PROFILE_START(var) unsigned long long var = profileNow();
+#define PROFILE_STOP(hProfile, phase, var) profileAdd(hProfile, phase, profileNow() - var);
+
+#else
+
+#define PROFILE_START(var)
+#define PROFILE_STOP(hProfile, phase, var)
+
+#endif
+
+#endif
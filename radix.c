@@ -0,0 +1,67 @@
+#include "radix.h"
+#include <string.h>
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_MIN 64 // smaller batches are sorted by insertion
+
+// Sorts the items by key, keeping the order of items with equal keys
+void radixSort(unsigned long long * keys, void ** items, size_t n,
+               unsigned long long * keyScratch, void ** itemScratch) {
+    if (n < RADIX_MIN) {
+        for (size_t i = 1; i < n; i++) {
+            unsigned long long key = keys[i];
+            void * item = items[i];
+            size_t insert = i;
+            while (insert > 0 && keys[insert - 1] > key) {
+                keys[insert] = keys[insert - 1];
+                items[insert] = items[insert - 1];
+                insert--;
+            }
+            keys[insert] = key;
+            items[insert] = item;
+        }
+        return;
+    }
+
+    unsigned long long * srcKeys = keys, * dstKeys = keyScratch;
+    void ** srcItems = items, ** dstItems = itemScratch;
+    size_t counts[RADIX_BUCKETS];
+
+    for (int shift = 0; shift < 64; shift += RADIX_BITS) {
+        memset(counts, 0, sizeof(counts));
+        for (size_t i = 0; i < n; i++) {
+            counts[(srcKeys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+        }
+
+        if (counts[(srcKeys[0] >> shift) & (RADIX_BUCKETS - 1)] == n) {
+            continue; // every key has the same digit
+        }
+
+        // turn the counts into the first position of each bucket
+        size_t position = 0;
+        for (size_t b = 0; b < RADIX_BUCKETS; b++) {
+            size_t count = counts[b];
+            counts[b] = position;
+            position += count;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            size_t to = counts[(srcKeys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+            dstKeys[to] = srcKeys[i];
+            dstItems[to] = srcItems[i];
+        }
+
+        unsigned long long * swapKeys = srcKeys;
+        srcKeys = dstKeys;
+        dstKeys = swapKeys;
+        void ** swapItems = srcItems;
+        srcItems = dstItems;
+        dstItems = swapItems;
+    }
+
+    if (srcKeys != keys) { // the last pass wrote to the scratch space
+        memcpy(keys, srcKeys, n * sizeof(unsigned long long));
+        memcpy(items, srcItems, n * sizeof(void *));
+    }
+}
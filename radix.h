@@ -0,0 +1,14 @@
+#ifndef RADIX_H_
+#define RADIX_H_
+
+#include <stdlib.h>
+
+// Defines the bulk ordering of a batch of items by a packed 64 bit key.
+
+// Sorts the items by key, keeping the order of items with equal keys
+// (least significant digit radix sort, small batches use an insertion sort)
+// keyScratch and itemScratch must hold n entries and are overwritten
+void radixSort(unsigned long long * keys, void ** items, size_t n,
+               unsigned long long * keyScratch, void ** itemScratch);
+
+#endif
@@ -0,0 +1,119 @@
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+#include "ring.h"
+
+#define RING_LINE 64 // bytes of a cache line, the indexes are kept apart
+
+// Define struct for a ring
+typedef struct {
+    _Alignas(RING_LINE) atomic_size_t head; // next item to take, written by the consumer
+    _Alignas(RING_LINE) atomic_size_t tail; // next slot to fill, written by the producer
+    _Alignas(RING_LINE) atomic_int closed;
+    size_t mask; // capacity - 1
+    size_t itemSize;
+    unsigned char * items;
+} RING;
+
+#define RNG(h) if (!h) { return 0; } RING * ring = (RING*)h;
+#define RNGN(h) if (!h) { return; } RING * ring = (RING*)h;
+
+// Creates a ring of the given capacity
+void * ringCreate(size_t itemSize, size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+
+    RING * ring = (RING *)aligned_alloc(RING_LINE, (sizeof(RING) + RING_LINE - 1) / RING_LINE * RING_LINE);
+    if (!ring) {
+        return NULL;
+    }
+
+    ring->items = (unsigned char *)malloc(size * itemSize);
+    if (!ring->items) {
+        free(ring);
+        return NULL;
+    }
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->closed, 0);
+    ring->mask = size - 1;
+    ring->itemSize = itemSize;
+
+    return ring;
+}
+
+// Deletes a ring
+void ringDelete(void * hRing) {
+    RNGN(hRing)
+
+    free(ring->items);
+    free(ring);
+}
+
+// Appends an item
+int ringPush(void * hRing, const void * item) {
+    RNG(hRing)
+
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&ring->head, memory_order_acquire) > ring->mask) {
+        return 0; // full
+    }
+
+    memcpy(ring->items + (tail & ring->mask) * ring->itemSize, item, ring->itemSize);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+    return 1;
+}
+
+// Takes the oldest item
+int ringPop(void * hRing, void * item) {
+    RNG(hRing)
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&ring->tail, memory_order_acquire)) {
+        return 0; // empty
+    }
+
+    memcpy(item, ring->items + (head & ring->mask) * ring->itemSize, ring->itemSize);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    return 1;
+}
+
+// Appends an item, waiting while the ring is full
+int ringPushWait(void * hRing, const void * item) {
+    RNG(hRing)
+
+    while (!ringPush(ring, item)) {
+        if (atomic_load_explicit(&ring->closed, memory_order_acquire)) {
+            return 0;
+        }
+        sched_yield();
+    }
+
+    return 1;
+}
+
+// Takes the oldest item, waiting while the ring is empty
+int ringPopWait(void * hRing, void * item) {
+    RNG(hRing)
+
+    while (!ringPop(ring, item)) {
+        if (atomic_load_explicit(&ring->closed, memory_order_acquire)) {
+            return ringPop(ring, item); // items pushed before the ring was closed
+        }
+        sched_yield();
+    }
+
+    return 1;
+}
+
+// Closes a ring
+void ringClose(void * hRing) {
+    RNGN(hRing)
+
+    atomic_store_explicit(&ring->closed, 1, memory_order_release);
+}
@@ -0,0 +1,41 @@
+#ifndef RING_H_
+#define RING_H_
+
+#include <stdlib.h>
+
+// Defines the single producer, single consumer ring of fixed size items that connects two threads.
+// The producer and the consumer each own one index and publish it with a release store, so neither
+// takes a lock; a thread that finds the ring full (or empty) yields and tries again.
+
+// Creates a ring of the given capacity (rounded up to a power of two)
+// Returns the pointer on success
+// Returns NULL if failed
+void * ringCreate(size_t itemSize, size_t capacity);
+
+// Deletes a ring
+void ringDelete(void * hRing);
+
+// Appends an item (producer)
+// Returns 1 on success
+// Returns 0 if the ring is full
+int ringPush(void * hRing, const void * item);
+
+// Takes the oldest item (consumer)
+// Returns 1 on success
+// Returns 0 if the ring is empty
+int ringPop(void * hRing, void * item);
+
+// Appends an item, waiting while the ring is full (producer)
+// Returns 1 on success
+// Returns 0 if the consumer closed the ring
+int ringPushWait(void * hRing, const void * item);
+
+// Takes the oldest item, waiting while the ring is empty (consumer)
+// Returns 1 on success
+// Returns 0 if the producer closed the ring and it is empty
+int ringPopWait(void * hRing, void * item);
+
+// Closes a ring: the other side stops waiting once it is drained (or at once for a producer)
+void ringClose(void * hRing);
+
+#endif
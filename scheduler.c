@@ -0,0 +1,308 @@
+#include <stdarg.h>
+#include "scheduler.h"
+#include "cpu.h"
+
+// Define struct for a scheduler
+typedef struct {
+    void * hCPU;
+    void * hLast; // last process fed
+    unsigned long long time; // first tick not simulated yet
+    SCHEDCALLBACK callback; // receiver of the events, NULL to keep them
+    void * context;
+    EVENT * events; // events kept for schedEvents, from events[eventHead]
+    size_t eventHead;
+    size_t eventCount;
+    size_t eventSize; // capacity of the kept events
+    unsigned int lost; // an event could not be kept
+    char error[SCHED_ERROR]; // message of the last error
+} SCHED;
+
+// Helper functions declaration
+
+// Hands an event of the cpu to the callback, or keeps it (cpu hook)
+static void schedEvent(void * hSched, const EVENT * event);
+
+// Keeps the error message of the cpu (cpu hook)
+static void schedKeepError(void * hSched, const char * message);
+
+// Sets the message of the last error
+static void schedReport(SCHED * sched, const char * format, ...);
+
+#define SCHD(h) if (!h) { return 0; } SCHED * sched = (SCHED*)h;
+#define SCHDN(h) if (!h) { return; } SCHED * sched = (SCHED*)h;
+
+// Creates a scheduler with the options of allocate
+void * schedCreate(int count, const char * const * options, SCHEDCALLBACK callback, void * context, char * error, size_t errorSize) {
+    SCHED * sched = (SCHED *)calloc(1, sizeof(SCHED));
+    char ** argv = (char **)calloc((size_t)(count > 0 ? count : 0) + 2, sizeof(char *));
+    if (!sched || !argv) {
+        if (error && errorSize > 0) {
+            snprintf(error, errorSize, "Failed to allocate memory for the scheduler.");
+        }
+        free(sched);
+        free(argv);
+        return NULL;
+    }
+    sched->callback = callback;
+    sched->context = context;
+
+    // the options follow the program name, as on the command line
+    argv[0] = "libscheduler";
+    for (int i = 0; i < count; i++) {
+        argv[i + 1] = (char *)options[i];
+    }
+
+    CPUHOOKS hooks;
+    hooks.event = schedEvent;
+    hooks.error = schedKeepError;
+    hooks.context = sched;
+    sched->hCPU = cpuInitEmbedded(count > 0 ? count + 1 : 1, argv, &hooks);
+    free(argv);
+
+    if (!sched->hCPU) {
+        if (error && errorSize > 0) {
+            snprintf(error, errorSize, "%s", sched->error[0] ? sched->error : "Failed to create the scheduler.");
+        }
+        free(sched);
+        return NULL;
+    }
+
+    if (error && errorSize > 0) {
+        error[0] = '\0';
+    }
+
+    return sched;
+}
+
+// Deletes a scheduler
+void schedDelete(void * hSched) {
+    SCHDN(hSched)
+
+    cpuDelete(sched->hCPU);
+    free(sched->events);
+    free(sched);
+}
+
+// Feeds a process
+int schedFeed(void * hSched, const SCHEDRECORD * record) {
+    SCHD(hSched)
+
+    if (!record) {
+        return 0;
+    }
+
+    if (record->arrival < sched->time) {
+        schedReport(sched, "Process %u arrives at %llu, before the time of the scheduler (%llu).", record->pid, record->arrival, sched->time);
+        return 0;
+    }
+
+    if (record->phases && record->phaseCount == 0) {
+        schedReport(sched, "Process %u has no bursts.", record->pid);
+        return 0;
+    }
+
+    // the bursts of a process with phases run in sequence
+    unsigned long long exec = record->execution;
+    unsigned int parallel = record->parallel != 0;
+    if (record->phases && record->phaseCount > 0) {
+        parallel = 0;
+        exec = 0;
+        for (unsigned int i = 0; i < record->phaseCount; i += 2) {
+            exec = record->phases[i] > ~0ULL - exec ? ~0ULL : exec + record->phases[i]; // saturates
+        }
+    }
+
+    TRACELINE line;
+    memset(&line, 0, sizeof(line));
+    line.pid = record->pid;
+    line.parallel = parallel;
+    line.tenant = record->tenant;
+    line.weight = record->weight;
+    line.hasWeight = record->weight != 0;
+    line.phaseCount = record->phases ? record->phaseCount : 0;
+    line.hProc = procCreate(record->arrival, record->pid, exec, parallel, cpuProcessors(sched->hCPU));
+    if (!line.hProc) {
+        schedReport(sched, "Failed to create process %u.", record->pid);
+        return 0;
+    }
+    procSetMemory(line.hProc, record->memory);
+
+    if (line.phaseCount > 0 && !subProcSetPhases(listGet(procSubsHandle(line.hProc), 0), record->phases, line.phaseCount)) {
+        schedReport(sched, "Process %u has an empty burst or ends with an I/O burst.", record->pid);
+        procDelete(line.hProc);
+        return 0;
+    }
+
+    if (!cpuFeed(sched->hCPU, &line)) {
+        return 0;
+    }
+    sched->hLast = line.hProc; // kept by the cpu until it is deleted
+
+    return 1;
+}
+
+// Feeds processes in order
+size_t schedFeedBulk(void * hSched, const SCHEDRECORD * records, size_t count) {
+    SCHD(hSched)
+
+    size_t fed = 0;
+    while (fed < count && schedFeed(sched, &records[fed])) {
+        fed++;
+    }
+
+    return fed;
+}
+
+// Simulates the ticks up to the given time
+int schedAdvance(void * hSched, unsigned long long time) {
+    SCHD(hSched)
+
+    while (sched->time < time && !sched->lost) {
+        // the ticks of an idle cpu, or one whose processes all finished, are empty up to the next arrival
+        unsigned long long next = cpuNextWork(sched->hCPU, sched->time);
+        if (next > sched->time) {
+            sched->time = next < time ? next : time;
+            continue;
+        }
+
+        cpuRun(sched->hCPU, sched->time);
+        sched->time++;
+    }
+
+    return !sched->lost;
+}
+
+// Moves the oldest kept events into a buffer
+size_t schedEvents(void * hSched, EVENT * events, size_t size) {
+    SCHD(hSched)
+
+    size_t moved = sched->eventCount < size ? sched->eventCount : size;
+    if (moved > 0) {
+        memcpy(events, sched->events + sched->eventHead, moved * sizeof(EVENT));
+    }
+    sched->eventHead += moved;
+    sched->eventCount -= moved;
+    if (sched->eventCount == 0) {
+        sched->eventHead = 0;
+    }
+
+    return moved;
+}
+
+// Gets the cpus the sub processes of the last process fed were placed on
+size_t schedPlaced(void * hSched, unsigned int * cpus, size_t size) {
+    SCHD(hSched)
+
+    if (!sched->hLast) {
+        return 0;
+    }
+
+    void * hSubProcs = procSubsHandle(sched->hLast);
+    size_t subs = listCount(hSubProcs), placed = 0;
+    for (size_t i = 0; i < subs; i++) {
+        void * hSubProc = listGet(hSubProcs, i);
+        if (!subProcPlaced(hSubProc)) {
+            continue;
+        }
+        if (i < size) {
+            cpus[i] = subProcCPU(hSubProc);
+        }
+        placed++;
+    }
+
+    return placed;
+}
+
+// Gets the number of kept events
+size_t schedPending(void * hSched) {
+    SCHD(hSched)
+
+    return sched->eventCount;
+}
+
+// Gets the first tick that is not simulated yet
+unsigned long long schedTime(void * hSched) {
+    SCHD(hSched)
+
+    return sched->time;
+}
+
+// Gets the statistics of the processes fed so far
+int schedStats(void * hSched, SCHEDSTATS * stats) {
+    SCHD(hSched)
+
+    if (!stats) {
+        return 0;
+    }
+
+    CPUSUMMARY summary;
+    cpuSummary(sched->hCPU, &summary);
+
+    memset(stats, 0, sizeof(SCHEDSTATS));
+    stats->time = sched->time;
+    stats->processes = summary.processes;
+    stats->finished = summary.finished;
+    stats->maxOverhead = summary.maxOverhead;
+    if (summary.finished > 0) {
+        stats->turnaround = summary.turnaround / (double)summary.finished;
+        stats->overhead = summary.overhead / (double)summary.finished;
+    }
+
+    return 1;
+}
+
+// Gets the message of the last error
+const char * schedError(void * hSched) {
+    if (!hSched) {
+        return "";
+    }
+
+    return ((SCHED *)hSched)->error;
+}
+
+// helper function definitions
+
+// Hands an event of the cpu to the callback, or keeps it
+static void schedEvent(void * hSched, const EVENT * event) {
+    SCHED * sched = (SCHED *)hSched;
+
+    if (sched->callback) {
+        sched->callback(sched->context, event);
+        return;
+    }
+
+    if (sched->eventHead + sched->eventCount == sched->eventSize) {
+        if (sched->eventHead > 0) {
+            // reuse the room of the events already read
+            memmove(sched->events, sched->events + sched->eventHead, sched->eventCount * sizeof(EVENT));
+            sched->eventHead = 0;
+        } else {
+            size_t size = sched->eventSize ? sched->eventSize * 2 : 1024;
+            EVENT * events = (EVENT *)realloc(sched->events, size * sizeof(EVENT));
+            if (!events) {
+                if (!sched->lost) {
+                    schedReport(sched, "Failed to allocate memory for the events.");
+                }
+                sched->lost = 1;
+                return;
+            }
+            sched->events = events;
+            sched->eventSize = size;
+        }
+    }
+
+    sched->events[sched->eventHead + sched->eventCount++] = *event;
+}
+
+// Keeps the error message of the cpu
+static void schedKeepError(void * hSched, const char * message) {
+    schedReport((SCHED *)hSched, "%s", message);
+}
+
+// Sets the message of the last error
+static void schedReport(SCHED * sched, const char * format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(sched->error, sizeof(sched->error), format, args);
+    va_end(args);
+}
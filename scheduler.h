@@ -0,0 +1,92 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+// Include dependencies
+#include <stdio.h>
+#include <stdlib.h>
+#include "sink.h"
+
+// Defines the scheduler library (make libscheduler), the simulator of allocate driven by another program.
+// A scheduler is created with the options of allocate, fed its processes in order of arrival and
+// advanced to a given time. The events of the ticks it simulates go to a callback, or are kept until
+// they are read into a buffer of the caller (see EVENT in sink.h).
+// A scheduler keeps all of its state in its handle and writes nothing to stdout or stderr, so a program
+// can run many of them at once (each one used by one thread at a time).
+
+#define SCHED_ERROR 256 // longest error message kept by a scheduler
+
+// Process fed to a scheduler, the columns of a line of the trace
+typedef struct {
+    unsigned long long arrival;
+    unsigned int pid;
+    unsigned long long execution; // execution time, the sum of the cpu bursts when the process has phases
+    unsigned int parallel; // the process can be split over the cpus (p column)
+    unsigned long long memory; // mem= column, 0 if none
+    const char * tenant; // tenant= column, NULL if none
+    unsigned int weight; // weight= column, 0 if none
+    const unsigned long long * phases; // phases= column: cpu, I/O, ..., cpu bursts, NULL if none
+    unsigned int phaseCount;
+} SCHEDRECORD;
+
+// Statistics of the processes fed to a scheduler
+typedef struct {
+    unsigned long long time; // first tick not simulated yet
+    size_t processes; // processes fed so far
+    size_t finished; // processes that finished
+    double turnaround; // mean turnaround time of the finished processes
+    double maxOverhead; // largest turnaround over execution time of the finished processes
+    double overhead; // mean turnaround over execution time of the finished processes
+} SCHEDSTATS;
+
+// Receives an event of a scheduler while it advances
+typedef void (*SCHEDCALLBACK)(void * context, const EVENT * event);
+
+// Creates a scheduler with the options of allocate, without the program name and -f
+// (e.g. "-p", "4", "-m", "2,4"); -o, -P, -s, -r, -d and -w cannot be used
+// The events go to the callback, or are kept for schedEvents if it is NULL
+// Returns the pointer on success
+// Returns NULL if the options are invalid or failed, with the reason in error (if not NULL)
+void * schedCreate(int count, const char * const * options, SCHEDCALLBACK callback, void * context, char * error, size_t errorSize);
+
+// Deletes a scheduler and the events it kept
+void schedDelete(void * hSched);
+
+// Feeds a process, which must not arrive before the current time (schedTime) or the last process fed
+// Returns 1 on success
+// Returns 0 if the process is invalid or failed (see schedError)
+int schedFeed(void * hSched, const SCHEDRECORD * record);
+
+// Feeds processes in order, stopping at the first one that cannot be fed
+// Returns the number of processes fed
+size_t schedFeedBulk(void * hSched, const SCHEDRECORD * records, size_t count);
+
+// Simulates the ticks up to the given time (excluded), the processes fed so far arrive on them
+// The ticks with no process to run or arriving are skipped
+// Returns 1 on success
+// Returns 0 if the events could not be kept or failed (see schedError)
+int schedAdvance(void * hSched, unsigned long long time);
+
+// Moves the oldest events kept by a scheduler without a callback into a buffer
+// Returns the number of events moved
+size_t schedEvents(void * hSched, EVENT * events, size_t size);
+
+// Gets the cpus the sub processes of the last process fed were placed on, cpus[i] for sub process i
+// Returns the number of sub processes placed, 0 while the process has not arrived or waits for
+// memory (-M) or for its gang (-g)
+size_t schedPlaced(void * hSched, unsigned int * cpus, size_t size);
+
+// Gets the number of events kept by a scheduler without a callback
+size_t schedPending(void * hSched);
+
+// Gets the first tick that is not simulated yet
+unsigned long long schedTime(void * hSched);
+
+// Gets the statistics of the processes fed so far
+// Returns 1 on success
+// Returns 0 if failed
+int schedStats(void * hSched, SCHEDSTATS * stats);
+
+// Gets the message of the last error of a scheduler, empty if none
+const char * schedError(void * hSched);
+
+#endif
@@ -0,0 +1,236 @@
+#include "select.h"
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SELECT_X86 1
+#endif
+
+#define SELECT_TAKEN (~0ULL) // marks a load that was already selected
+#define SELECT_SCAN_MAX 8 // largest selection made with repeated min-reductions
+
+// Helper functions declaration
+
+// Finds the least load of the array
+typedef unsigned long long (*SELECTMIN)(const unsigned long long * loads, size_t n);
+
+// Finds the least load with scalar code
+static unsigned long long selectMinScalar(const unsigned long long * loads, size_t n);
+
+#ifdef SELECT_X86
+// Finds the least load with AVX2
+static unsigned long long selectMinAVX2(const unsigned long long * loads, size_t n);
+
+// Finds the least load with SSE4.2
+static unsigned long long selectMinSSE42(const unsigned long long * loads, size_t n);
+#endif
+
+// Picks the min-reduction supported by the machine
+static SELECTMIN selectMinKernel();
+
+// Sets the min-reduction once, for every thread
+static void selectMinInit(void);
+
+// Selects the k least (load, tie, id) keys with a bounded max-heap, ties is NULL for (load, id) keys
+// heap must hold k keys and is overwritten
+static void selectBounded(const unsigned long long * loads, const unsigned long long * ties, size_t n, size_t k, unsigned int * out, unsigned long long * heap);
+
+// Checks if a key comes after another one, both of width values ending with the id
+// Returns 1 if it does
+// Returns 0 otherwise
+static int selectAfter(const unsigned long long * a, const unsigned long long * b, size_t width);
+
+// Moves the key at a position of the max-heap down to its place
+static void selectSiftDown(unsigned long long * heap, size_t count, size_t position, size_t width);
+
+// min-reduction of the machine, set by the first selection of any scheduler
+static SELECTMIN selectMin = NULL;
+static pthread_once_t selectMinOnce = PTHREAD_ONCE_INIT;
+
+// Selects the k cpus with the least load
+void selectLeast(const unsigned long long * loads, size_t n, size_t k, unsigned int * out, unsigned long long * scratch) {
+    if (k > n) {
+        k = n;
+    }
+
+    if (k > SELECT_SCAN_MAX) {
+        selectBounded(loads, NULL, n, k, out, scratch);
+        return;
+    }
+
+    // embedded schedulers may select from several threads at once
+    pthread_once(&selectMinOnce, selectMinInit);
+
+    // repeated min-reduction, the selected loads are marked as taken
+    for (size_t i = 0; i < n; i++) {
+        scratch[i] = loads[i];
+    }
+
+    for (size_t i = 0; i < k; i++) {
+        unsigned long long least = selectMin(scratch, n);
+        size_t id = 0;
+        while (scratch[id] != least) { // first cpu with the least load has the smallest id
+            id++;
+        }
+        out[i] = (unsigned int)id;
+        scratch[id] = SELECT_TAKEN;
+    }
+}
+
+// Selects the k cpus with the least load and second key
+void selectLeastPair(const unsigned long long * loads, const unsigned long long * ties, size_t n, size_t k, unsigned int * out, unsigned long long * scratch) {
+    if (k > n) {
+        k = n;
+    }
+
+    selectBounded(loads, ties, n, k, out, scratch);
+}
+
+// helper function definitions
+
+// Finds the least load with scalar code
+static unsigned long long selectMinScalar(const unsigned long long * loads, size_t n) {
+    unsigned long long least = SELECT_TAKEN;
+
+    for (size_t i = 0; i < n; i++) {
+        if (loads[i] < least) {
+            least = loads[i];
+        }
+    }
+
+    return least;
+}
+
+#ifdef SELECT_X86
+// Finds the least load with AVX2
+// There is no unsigned 64 bit compare, so the sign bit is flipped before a signed compare
+__attribute__((target("avx2")))
+static unsigned long long selectMinAVX2(const unsigned long long * loads, size_t n) {
+    const __m256i bias = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+    __m256i least = _mm256_set1_epi64x((long long)(SELECT_TAKEN ^ 0x8000000000000000ULL));
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(loads + i)), bias);
+        least = _mm256_blendv_epi8(least, v, _mm256_cmpgt_epi64(least, v));
+    }
+
+    unsigned long long lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, _mm256_xor_si256(least, bias));
+
+    unsigned long long result = selectMinScalar(lanes, 4);
+    unsigned long long tail = selectMinScalar(loads + i, n - i);
+
+    return tail < result ? tail : result;
+}
+
+// Finds the least load with SSE4.2
+__attribute__((target("sse4.2")))
+static unsigned long long selectMinSSE42(const unsigned long long * loads, size_t n) {
+    const __m128i bias = _mm_set1_epi64x((long long)0x8000000000000000ULL);
+    __m128i least = _mm_set1_epi64x((long long)(SELECT_TAKEN ^ 0x8000000000000000ULL));
+    size_t i = 0;
+
+    for (; i + 2 <= n; i += 2) {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(loads + i)), bias);
+        least = _mm_blendv_epi8(least, v, _mm_cmpgt_epi64(least, v));
+    }
+
+    unsigned long long lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, _mm_xor_si128(least, bias));
+
+    unsigned long long result = selectMinScalar(lanes, 2);
+    unsigned long long tail = selectMinScalar(loads + i, n - i);
+
+    return tail < result ? tail : result;
+}
+#endif
+
+// Picks the min-reduction supported by the machine
+static SELECTMIN selectMinKernel() {
+#ifdef SELECT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return selectMinAVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return selectMinSSE42;
+    }
+#endif
+    return selectMinScalar;
+}
+
+// Sets the min-reduction once, for every thread
+static void selectMinInit(void) {
+    selectMin = selectMinKernel();
+}
+
+// Selects the k least (load, tie, id) keys with a bounded max-heap
+// The heap keeps the k least keys seen so far with the greatest on top, so each cpu costs at most
+// log k comparisons; the heap is then emptied greatest first into out
+static void selectBounded(const unsigned long long * loads, const unsigned long long * ties, size_t n, size_t k, unsigned int * out, unsigned long long * heap) {
+    size_t width = ties ? 3 : 2;
+    size_t count = 0;
+
+    if (k == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        unsigned long long key[3] = { loads[i], ties ? ties[i] : i, i };
+
+        if (count < k) {
+            // sift the key up from the end
+            size_t position = count++;
+            while (position > 0 && selectAfter(key, heap + (position - 1) / 2 * width, width)) {
+                memcpy(heap + position * width, heap + (position - 1) / 2 * width, width * sizeof(unsigned long long));
+                position = (position - 1) / 2;
+            }
+            memcpy(heap + position * width, key, width * sizeof(unsigned long long));
+        } else if (selectAfter(heap, key, width)) {
+            // the key replaces the greatest of the k least
+            memcpy(heap, key, width * sizeof(unsigned long long));
+            selectSiftDown(heap, count, 0, width);
+        }
+    }
+
+    while (count > 0) {
+        out[--count] = (unsigned int)heap[width - 1];
+        memcpy(heap, heap + count * width, width * sizeof(unsigned long long));
+        selectSiftDown(heap, count, 0, width);
+    }
+}
+
+// Checks if a key comes after another one, both of width values ending with the id
+static int selectAfter(const unsigned long long * a, const unsigned long long * b, size_t width) {
+    for (size_t i = 0; i < width; i++) {
+        if (a[i] != b[i]) {
+            return a[i] > b[i];
+        }
+    }
+
+    return 0;
+}
+
+// Moves the key at a position of the max-heap down to its place
+static void selectSiftDown(unsigned long long * heap, size_t count, size_t position, size_t width) {
+    unsigned long long key[3];
+    memcpy(key, heap + position * width, width * sizeof(unsigned long long));
+
+    for (;;) {
+        size_t child = 2 * position + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && selectAfter(heap + (child + 1) * width, heap + child * width, width)) {
+            child++;
+        }
+        if (!selectAfter(heap + child * width, key, width)) {
+            break;
+        }
+        memcpy(heap + position * width, heap + child * width, width * sizeof(unsigned long long));
+        position = child;
+    }
+    memcpy(heap + position * width, key, width * sizeof(unsigned long long));
+}
@@ -0,0 +1,23 @@
+#ifndef SELECT_H_
+#define SELECT_H_
+
+#include <stdlib.h>
+
+// Defines the selection of the least loaded cpus.
+// The loads are a flat array indexed by cpu id. Small selections are made with repeated
+// vectorised min-reductions (AVX2 or SSE4.2 when the machine supports them, scalar otherwise),
+// larger ones keep the k least (load, id) pairs in a bounded heap, in O(n log k).
+
+// Selects the k cpus with the least load, ties broken by the smaller id
+// Loads must be smaller than the maximum unsigned long long value
+// scratch must hold 2 * n values and is overwritten
+// Writes the ids of the selected cpus to out, from least to greatest load
+void selectLeast(const unsigned long long * loads, size_t n, size_t k, unsigned int * out, unsigned long long * scratch);
+
+// Selects the k cpus with the least load, ties broken by the smaller second key and then the smaller id
+// (the waiting time and remaining time of the cpus with -c)
+// scratch must hold 3 * n values and is overwritten
+// Writes the ids of the selected cpus to out, from least to greatest load
+void selectLeastPair(const unsigned long long * loads, const unsigned long long * ties, size_t n, size_t k, unsigned int * out, unsigned long long * scratch);
+
+#endif
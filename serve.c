@@ -0,0 +1,271 @@
+#include <string.h>
+#include <time.h>
+#include "serve.h"
+#include "scheduler.h"
+#include "trace.h"
+
+// Define struct for the state of the service
+typedef struct {
+    void * hSched;
+    FILE * hOutput;
+    unsigned long long * phases; // bursts of the phases= column of the current line
+    size_t phaseSize;
+    unsigned int * cpus; // cpus of the sub processes of the current process
+    size_t cpuSize;
+    unsigned long long * latencies; // time of each decision, in nanoseconds
+    size_t decisions;
+    size_t latencySize;
+} SERVICE;
+
+// Helper functions declaration
+
+// Parses a line of the trace format into a record, with the parser of the traces
+// Returns 1 on success
+// Returns 0 if the line is blank, malformed or rejected by the service (psReject is set, and pHasPid if
+// record->pid is known) or failed
+static int serveParse(SERVICE * service, char * sLine, SCHEDRECORD * record, const char ** psReject, int * pHasPid);
+
+// Places a process and writes the answer
+// Returns 1 on success
+// Returns 0 if failed
+static int serveDecide(SERVICE * service, SCHEDRECORD * record);
+
+// Writes the decision times to stderr
+static void serveReport(SERVICE * service);
+
+// Ignores an event of the run
+static void serveEvent(void * context, const EVENT * event);
+
+// Gets the monotonic time in nanoseconds
+static unsigned long long serveClock(void);
+
+// Compares two decision times
+static int serveCompare(const void * a, const void * b);
+
+// Checks if the arguments ask for the service
+int serveRequested(int argc, char ** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--serve") == 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Runs the service until the end of the input
+int serveRun(int argc, char ** argv, FILE * hInput, FILE * hOutput) {
+    SERVICE service;
+    memset(&service, 0, sizeof(service));
+    service.hOutput = hOutput;
+
+    // the scheduler takes the options of allocate, --serve is skipped as an unknown one
+    char error[SCHED_ERROR];
+    service.hSched = schedCreate(argc - 1, (const char * const *)argv + 1, serveEvent, NULL, error, sizeof(error));
+    if (!service.hSched) {
+        fprintf(stderr, "%s\n", error);
+        return 0;
+    }
+
+    int failed = 0;
+    char * sLine = NULL;
+    size_t lineSize = 0, lineNumber = 0;
+    while (!failed && getline(&sLine, &lineSize, hInput) != -1) {
+        SCHEDRECORD record;
+        const char * sReject = NULL;
+        int hasPid = 0;
+        lineNumber++;
+        if (!serveParse(&service, sLine, &record, &sReject, &hasPid)) {
+            // every line but a blank one gets an answer, a malformed one without a pid is named by its line
+            if (sReject && hasPid) {
+                fprintf(hOutput, "%llu,REJECTED,pid=%u\n", schedTime(service.hSched), record.pid);
+                fprintf(stderr, "Process %u %s.\n", record.pid, sReject);
+            } else if (sReject) {
+                fprintf(hOutput, "%llu,REJECTED,line=%zu\n", schedTime(service.hSched), lineNumber);
+                fprintf(stderr, "Line %zu %s.\n", lineNumber, sReject);
+            }
+            fflush(hOutput);
+            continue; // skip blank lines
+        }
+
+        failed = !serveDecide(&service, &record);
+    }
+    free(sLine);
+
+    serveReport(&service);
+
+    schedDelete(service.hSched);
+    free(service.phases);
+    free(service.cpus);
+    free(service.latencies);
+
+    return !failed;
+}
+
+// helper function definitions
+
+// Parses a line of the trace format into a record
+// A weight of 0 means none to the scheduler, so a zero weight= column is rejected here like the
+// trace loader does
+static int serveParse(SERVICE * service, char * sLine, SCHEDRECORD * record, const char ** psReject, int * pHasPid) {
+    TRACEFIELDS fields;
+
+    memset(record, 0, sizeof(SCHEDRECORD));
+    int split = traceSplit(sLine, &fields);
+    record->pid = fields.pid;
+    *pHasPid = fields.hasPid;
+    if (!split) {
+        *psReject = fields.error; // NULL for a blank line
+        return 0;
+    }
+    record->arrival = fields.arrival;
+    record->execution = fields.execution;
+    record->parallel = fields.parallel;
+    record->memory = fields.memory;
+    record->tenant = fields.tenant; // the scheduler copies the name
+    record->weight = (unsigned int)fields.weight;
+
+    if (fields.after) {
+        *psReject = "has an after= column, which the service cannot resolve";
+        return 0;
+    }
+    if (fields.hasWeight && fields.weight == 0) {
+        *psReject = "has a zero weight";
+        return 0;
+    }
+
+    const char * sList = fields.phases;
+    unsigned long long burst = 0;
+    while (sList && traceNext(&sList, &burst)) {
+        if (record->phaseCount == service->phaseSize) {
+            size_t size = service->phaseSize ? service->phaseSize * 2 : 16;
+            unsigned long long * phases = (unsigned long long *)realloc(service->phases, size * sizeof(unsigned long long));
+            if (!phases) {
+                *psReject = "has more bursts than the memory holds";
+                return 0;
+            }
+            service->phases = phases;
+            service->phaseSize = size;
+        }
+        service->phases[record->phaseCount++] = burst;
+    }
+    if (fields.phases && record->phaseCount == 0) {
+        *psReject = "has no bursts";
+        return 0;
+    }
+    if (record->phaseCount > 0) {
+        record->phases = service->phases;
+    }
+
+    return 1;
+}
+
+// Places a process and writes the answer
+// The ticks up to the arrival are simulated first, then the arrival tick places the process
+static int serveDecide(SERVICE * service, SCHEDRECORD * record) {
+    void * hSched = service->hSched;
+    unsigned long long start = serveClock();
+
+    if (record->arrival < schedTime(hSched)) {
+        record->arrival = schedTime(hSched); // arrives now
+    }
+
+    if (!schedAdvance(hSched, record->arrival)) {
+        fprintf(stderr, "%s\n", schedError(hSched));
+        return 0;
+    }
+
+    if (!schedFeed(hSched, record)) {
+        fprintf(service->hOutput, "%llu,REJECTED,pid=%u\n", record->arrival, record->pid);
+        fflush(service->hOutput);
+        fprintf(stderr, "%s\n", schedError(hSched));
+        return 1; // the service goes on
+    }
+
+    if (!schedAdvance(hSched, record->arrival + 1)) {
+        fprintf(stderr, "%s\n", schedError(hSched));
+        return 0;
+    }
+
+    size_t placed = schedPlaced(hSched, service->cpus, service->cpuSize);
+    if (placed > service->cpuSize) {
+        unsigned int * cpus = (unsigned int *)realloc(service->cpus, placed * sizeof(unsigned int));
+        if (!cpus) {
+            fprintf(stderr, "Failed to allocate memory for the cpus of process %u.\n", record->pid);
+            return 0;
+        }
+        service->cpus = cpus;
+        service->cpuSize = placed;
+        schedPlaced(hSched, service->cpus, service->cpuSize);
+    }
+
+    // the decision is made, writing it is not part of its time
+    unsigned long long latency = serveClock() - start;
+
+    if (placed == 0) {
+        fprintf(service->hOutput, "%llu,WAITING,pid=%u\n", record->arrival, record->pid);
+    } else if (placed == 1) {
+        fprintf(service->hOutput, "%llu,PLACED,pid=%u,cpu=%u\n", record->arrival, record->pid, service->cpus[0]);
+    } else {
+        for (size_t i = 0; i < placed; i++) {
+            fprintf(service->hOutput, "%llu,PLACED,pid=%u.%zu,cpu=%u\n", record->arrival, record->pid, i, service->cpus[i]);
+        }
+    }
+    fflush(service->hOutput);
+
+    if (service->decisions == service->latencySize) {
+        size_t size = service->latencySize ? service->latencySize * 2 : SERVE_LATENCIES;
+        unsigned long long * latencies = (unsigned long long *)realloc(service->latencies, size * sizeof(unsigned long long));
+        if (!latencies) {
+            fprintf(stderr, "Failed to allocate memory for the decision times.\n");
+            return 0;
+        }
+        service->latencies = latencies;
+        service->latencySize = size;
+    }
+    service->latencies[service->decisions++] = latency;
+
+    return 1;
+}
+
+// Writes the decision times to stderr
+static void serveReport(SERVICE * service) {
+    size_t n = service->decisions;
+    if (n == 0) {
+        fprintf(stderr, "Decisions 0\n");
+        return;
+    }
+
+    qsort(service->latencies, n, sizeof(unsigned long long), serveCompare);
+
+    double percentile[2];
+    const unsigned int ranks[2] = { 50, 99 };
+    for (size_t j = 0; j < 2; j++) {
+        size_t rank = (ranks[j] * n + 99) / 100; // nearest rank
+        percentile[j] = (double)service->latencies[rank - 1] / 1000.0;
+    }
+
+    fprintf(stderr, "Decisions %zu\n", n);
+    fprintf(stderr, "Decision time p50 %.1f us p99 %.1f us\n", percentile[0], percentile[1]);
+}
+
+// Ignores an event of the run
+static void serveEvent(void * context, const EVENT * event) {
+    (void)context;
+    (void)event;
+}
+
+// Gets the monotonic time in nanoseconds
+static unsigned long long serveClock(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (unsigned long long)now.tv_sec * 1000000000ULL + (unsigned long long)now.tv_nsec;
+}
+
+// Compares two decision times
+static int serveCompare(const void * a, const void * b) {
+    unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+
+    return (x > y) - (x < y);
+}
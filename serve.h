@@ -0,0 +1,30 @@
+#ifndef SERVE_H_
+#define SERVE_H_
+
+// Include dependencies
+#include <stdio.h>
+#include <stdlib.h>
+
+// Defines the placement service (allocate --serve).
+// The service keeps one scheduler alive (see scheduler.h) and reads the processes from its input as they
+// come, one line of the trace format each. A process is simulated up to its arrival tick and answered at
+// once with the cpus it was placed on:
+//   <time>,PLACED,pid=<pid>[.<sub>],cpu=<cpu>   one line per sub process
+//   <time>,WAITING,pid=<pid>                    waiting for memory (-M) or for its gang (-g)
+//   <time>,REJECTED,pid=<pid>                   invalid process, the reason goes to stderr
+// A process that arrives before the tick of the service arrives on that tick. The events of the run are
+// not written. At the end of the input the decision times (p50 and p99) are reported on stderr.
+
+#define SERVE_LATENCIES 4096 // initial capacity of the decision times
+
+// Checks if the arguments ask for the service
+// Returns 1 if they do
+// Returns 0 otherwise
+int serveRequested(int argc, char ** argv);
+
+// Runs the service until the end of the input
+// Returns 1 on success
+// Returns 0 if the options are invalid or failed
+int serveRun(int argc, char ** argv, FILE * hInput, FILE * hOutput);
+
+#endif
@@ -0,0 +1,243 @@
+#include <pthread.h>
+#include "sink.h"
+#include "evlog.h"
+#include "ring.h"
+
+// Define struct for the execution segment open on a cpu
+typedef struct {
+    unsigned int open;
+    unsigned long long start;
+    unsigned int pid;
+    unsigned int sub;
+    unsigned long long remaining;
+} SEGMENT;
+
+// Define struct for a sink
+typedef struct {
+    SINKFORMAT format;
+    FILE * hFile;
+    unsigned int processors;
+    SEGMENT * segments; // segment open on each cpu (interval format)
+    void * hWriter; // writer of the event log (binary format)
+    void * hRing; // events waiting for the writer thread
+    pthread_t thread;
+    void (*callback)(void * context, const EVENT * event); // receiver of the events (callback format)
+    void * context;
+} SINK;
+
+static const char * stopNames[] = {
+    "completed",
+    "preempted",
+    "blocked"
+};
+
+// Helper functions declaration
+
+// Writes an event in the format of the sink
+static unsigned long long sinkFormat(SINK * sink, const EVENT * event);
+
+// Writes the events of the ring until it is closed (thread entry)
+static void * sinkWriter(void * hSink);
+
+// Writes an event as a line of the default format
+static unsigned long long sinkWriteText(SINK * sink, const EVENT * event);
+
+// Writes an event to the interval format: running events open a segment, stopped events write it
+static unsigned long long sinkWriteInterval(SINK * sink, const EVENT * event);
+
+#define SNK(h) if (!h) { return 0; } SINK * sink = (SINK*)h;
+#define SNKN(h) if (!h) { return; } SINK * sink = (SINK*)h;
+
+// Creates a sink writing to a file
+void * sinkCreate(SINKFORMAT format, FILE * hFile, unsigned int processors) {
+    SINK * sink = (SINK *)calloc(1, sizeof(SINK));
+    if (!sink) {
+        return NULL;
+    }
+
+    sink->format = format;
+    sink->hFile = hFile;
+    sink->processors = processors;
+
+    if (format == SINK_INTERVAL) {
+        sink->segments = (SEGMENT *)calloc(processors + 1, sizeof(SEGMENT));
+        if (!sink->segments) {
+            free(sink);
+            return NULL;
+        }
+    } else if (format == SINK_BINARY) {
+        sink->hWriter = evlogCreate(hFile);
+        if (!sink->hWriter) {
+            free(sink);
+            return NULL;
+        }
+    }
+
+    return sink;
+}
+
+// Creates a sink handing every event to a function
+void * sinkCreateCallback(void (*callback)(void * context, const EVENT * event), void * context, unsigned int processors) {
+    if (!callback) {
+        return NULL;
+    }
+
+    SINK * sink = (SINK *)sinkCreate(SINK_CALLBACK, NULL, processors);
+    if (!sink) {
+        return NULL;
+    }
+    sink->callback = callback;
+    sink->context = context;
+
+    return sink;
+}
+
+// Deletes a sink
+void sinkDelete(void * hSink) {
+    SNKN(hSink)
+
+    sinkStopThread(sink);
+    free(sink->segments);
+    evlogFinish(sink->hWriter); // a failed write leaves the error indicator of the file set
+    free(sink);
+}
+
+// Checks if the sink needs the stopped events
+int sinkWantsStops(void * hSink) {
+    SNK(hSink)
+
+    return sink->format == SINK_INTERVAL || sink->format == SINK_BINARY || sink->format == SINK_CALLBACK;
+}
+
+// Writes an event
+unsigned long long sinkWrite(void * hSink, const EVENT * event) {
+    SNK(hSink)
+
+    if (sink->hRing) {
+        ringPushWait(sink->hRing, event);
+        return 0;
+    }
+
+    return sinkFormat(sink, event);
+}
+
+// Moves the writing of the events to a thread of its own
+int sinkStartThread(void * hSink) {
+    SNK(hSink)
+
+    if (sink->hRing) {
+        return 1;
+    }
+
+    sink->hRing = ringCreate(sizeof(EVENT), SINK_RING_EVENTS);
+    if (!sink->hRing) {
+        return 0;
+    }
+
+    if (pthread_create(&sink->thread, NULL, sinkWriter, sink) != 0) {
+        ringDelete(sink->hRing);
+        sink->hRing = NULL;
+        return 0;
+    }
+
+    return 1;
+}
+
+// Writes the events waiting for the writer thread and stops it
+void sinkStopThread(void * hSink) {
+    SNKN(hSink)
+
+    if (!sink->hRing) {
+        return;
+    }
+
+    ringClose(sink->hRing);
+    pthread_join(sink->thread, NULL);
+    ringDelete(sink->hRing);
+    sink->hRing = NULL;
+}
+
+// helper function definitions
+
+// Writes an event in the format of the sink
+static unsigned long long sinkFormat(SINK * sink, const EVENT * event) {
+    switch (sink->format) {
+        case SINK_INTERVAL: return sinkWriteInterval(sink, event);
+        case SINK_BINARY: evlogAppend(sink->hWriter, event); return 0;
+        case SINK_CALLBACK: sink->callback(sink->context, event); return 0;
+        default: return sinkWriteText(sink, event);
+    }
+}
+
+// Writes the events of the ring until it is closed
+static void * sinkWriter(void * hSink) {
+    SINK * sink = (SINK *)hSink;
+    EVENT event;
+
+    while (ringPopWait(sink->hRing, &event)) {
+        sinkFormat(sink, &event);
+    }
+
+    return NULL;
+}
+
+// Writes an event as a line of the default format
+static unsigned long long sinkWriteText(SINK * sink, const EVENT * event) {
+    int written = 0;
+
+    if (event->type == EVENT_FINISHED) {
+        written = fprintf(sink->hFile, "%llu,FINISHED,pid=%u,proc_remaining=%llu\n", event->time, event->pid, event->value);
+    } else if (event->type == EVENT_RUNNING) {
+        if (event->sub != EVENT_NOSUB) { // is parallel
+            written = fprintf(sink->hFile, "%llu,RUNNING,pid=%u.%u,remaining_time=%llu,cpu=%u\n", event->time, event->pid, event->sub, event->value, event->cpu);
+        } else {
+            written = fprintf(sink->hFile, "%llu,RUNNING,pid=%u,remaining_time=%llu,cpu=%u\n", event->time, event->pid, event->value, event->cpu);
+        }
+    } else if (event->type == EVENT_STOPPED) {
+        const char * reason = event->value <= STOP_BLOCKED ? stopNames[event->value] : "unknown";
+        if (event->sub != EVENT_NOSUB) {
+            written = fprintf(sink->hFile, "%llu,STOPPED,pid=%u.%u,cpu=%u,reason=%s\n", event->time, event->pid, event->sub, event->cpu, reason);
+        } else {
+            written = fprintf(sink->hFile, "%llu,STOPPED,pid=%u,cpu=%u,reason=%s\n", event->time, event->pid, event->cpu, reason);
+        }
+    }
+
+    return written > 0 ? (unsigned long long)written : 0;
+}
+
+// Writes an event to the interval format
+// Lines are F,<time>,<pid>,<unfinished processes> for a finished process and
+// S,<cpu>,<pid>[.<sub>],<start>,<end>,<remaining time at start>,<reason> for a segment
+static unsigned long long sinkWriteInterval(SINK * sink, const EVENT * event) {
+    int written = 0;
+
+    if (event->cpu >= sink->processors && event->type != EVENT_FINISHED) {
+        return 0;
+    }
+
+    SEGMENT * segment = &sink->segments[event->cpu];
+
+    if (event->type == EVENT_FINISHED) {
+        written = fprintf(sink->hFile, "F,%llu,%u,%llu\n", event->time, event->pid, event->value);
+    } else if (event->type == EVENT_RUNNING) {
+        segment->open = 1;
+        segment->start = event->time;
+        segment->pid = event->pid;
+        segment->sub = event->sub;
+        segment->remaining = event->value;
+    } else if (event->type == EVENT_STOPPED && segment->open) {
+        const char * reason = event->value <= STOP_BLOCKED ? stopNames[event->value] : "unknown";
+        unsigned long long end = event->time > segment->start ? event->time : segment->start;
+
+        if (segment->sub != EVENT_NOSUB) {
+            written = fprintf(sink->hFile, "S,%u,%u.%u,%llu,%llu,%llu,%s\n", event->cpu, segment->pid, segment->sub,
+                              segment->start, end, segment->remaining, reason);
+        } else {
+            written = fprintf(sink->hFile, "S,%u,%u,%llu,%llu,%llu,%s\n", event->cpu, segment->pid,
+                              segment->start, end, segment->remaining, reason);
+        }
+        segment->open = 0;
+    }
+
+    return written > 0 ? (unsigned long long)written : 0;
+}
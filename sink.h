@@ -0,0 +1,77 @@
+#ifndef SINK_H_
+#define SINK_H_
+
+// Include dependencies
+#include <stdio.h>
+#include <stdlib.h>
+
+// Defines the events of a run and the sinks that write them.
+// The simulator reports each event once; the sink decides how it is written, so the output
+// formats do not depend on the scheduling code.
+
+// Types of events
+typedef enum {
+    EVENT_FINISHED = 0, // a process finished
+    EVENT_RUNNING,      // a sub process started running on a cpu
+    EVENT_STOPPED       // the sub process running on a cpu stopped (only reported to sinks that want it)
+} EVENTTYPE;
+
+// Reasons a sub process stopped running
+typedef enum {
+    STOP_COMPLETED = 0, // it completed
+    STOP_PREEMPTED,     // another sub process took its cpu
+    STOP_BLOCKED        // it blocked on an I/O burst
+} STOPREASON;
+
+#define EVENT_NOSUB 0xffffffffu // sub id of a process that is not parallel
+#define SINK_RING_EVENTS 16384 // events queued for the writer thread
+
+// Event of a run
+typedef struct {
+    unsigned long long time; // tick of the event, the last tick it ran for a stopped sub process
+    EVENTTYPE type;
+    unsigned int pid;
+    unsigned int sub; // id of the sub process, EVENT_NOSUB if the process is not parallel
+    unsigned int cpu;
+    unsigned long long value; // remaining time with the tick (running), unfinished processes (finished), STOPREASON (stopped)
+} EVENT;
+
+// Output formats
+typedef enum {
+    SINK_TEXT = 0, // one line per event
+    SINK_INTERVAL, // one line per execution segment and finished process
+    SINK_BINARY,   // binary event log, see evlog.h
+    SINK_CALLBACK  // events handed to a function (embedded schedulers, see scheduler.h)
+} SINKFORMAT;
+
+// Creates a sink writing to a file
+// Returns the pointer on success
+// Returns NULL if failed
+void * sinkCreate(SINKFORMAT format, FILE * hFile, unsigned int processors);
+
+// Creates a sink handing every event, stopped events included, to a function
+// Returns the pointer on success
+// Returns NULL if failed
+void * sinkCreateCallback(void (*callback)(void * context, const EVENT * event), void * context, unsigned int processors);
+
+// Deletes a sink, writing what it buffered; the file is left open
+void sinkDelete(void * hSink);
+
+// Checks if the sink needs the stopped events
+// Returns 1 if it does
+// Returns 0 otherwise
+int sinkWantsStops(void * hSink);
+
+// Writes an event
+// Returns the number of bytes written (0 while they are buffered or written by the writer thread)
+unsigned long long sinkWrite(void * hSink, const EVENT * event);
+
+// Moves the formatting and writing of the events to a thread of its own, sinkWrite only queues them
+// Returns 1 on success
+// Returns 0 if failed (the events are still written by sinkWrite)
+int sinkStartThread(void * hSink);
+
+// Writes the events queued for the writer thread and stops it, sinkWrite writes them again
+void sinkStopThread(void * hSink);
+
+#endif
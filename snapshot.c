@@ -0,0 +1,331 @@
+#include "snapshot.h"
+#include "cpu.h"
+
+// Snapshot record layout, in 32 bit words:
+//   header (SNAP_HEADER words, see below)
+//   worked and completion of every sub process, in trace order (SNAP_SUB words)
+//   for each processor: current sub process, pending count, pending sub processes in queue order
+//   checksum of all the previous words
+// Sub processes are referenced by their position in the trace order. Times and counters of 64 bits
+// take two words, the low one first.
+
+#define SNAP_MAGIC 0x50414e53 // "SNAP"
+#define SNAP_VERSION 2 // version 1 had 32 bit times
+#define SNAP_NONE 0xffffffffu // no sub process
+
+enum {
+    SNAP_H_MAGIC = 0,
+    SNAP_H_VERSION,
+    SNAP_H_WORDS, // length of the record including the checksum
+    SNAP_H_TIME_LO,
+    SNAP_H_TIME_HI,
+    SNAP_H_EMITTED_LO,
+    SNAP_H_EMITTED_HI,
+    SNAP_H_PROCESSORS,
+    SNAP_H_PROCS,
+    SNAP_H_SUBPROCS,
+    SNAP_H_UNFINISHED,
+    SNAP_H_FINISHED,
+    SNAP_HEADER
+};
+
+#define SNAP_SUB 4 // words of each sub process: worked and completion
+
+// Maps the handle of a sub process to its position in the trace order
+typedef struct {
+    void * hSubProc;
+    unsigned int index;
+} SUBPROCREF;
+
+// Helper functions declaration
+
+// Computes the checksum of a record (FNV-1a)
+static unsigned int snapshotChecksum(const unsigned int * words, size_t count);
+
+// Builds the table of sub process references sorted by handle
+// Returns NULL if failed
+static SUBPROCREF * snapshotRefs(void * hProcs, size_t * pCount);
+
+// Compares two sub process references by handle
+static int snapshotRefCompare(const void * a, const void * b);
+
+// Finds the position of a sub process in the trace order
+static unsigned int snapshotRefIndex(SUBPROCREF * refs, size_t count, void * hSubProc);
+
+// Stores a 64 bit value in two words, the low one first
+static void snapshotSplit(unsigned int * words, unsigned long long value);
+
+// Reads a 64 bit value stored in two words
+static unsigned long long snapshotJoin(const unsigned int * words);
+
+// Appends a snapshot of the simulator state at the end of the given tick
+int snapshotSave(const char * fileName, unsigned long long time, unsigned long long emitted,
+                 unsigned int unfinished, unsigned int finished,
+                 void * hProcs, void * hProcessors) {
+    size_t subCount = 0;
+    SUBPROCREF * refs = snapshotRefs(hProcs, &subCount);
+    if (!refs) {
+        return 0;
+    }
+
+    size_t processors = listCount(hProcessors);
+    size_t words = SNAP_HEADER + SNAP_SUB * subCount + 1;
+    for (size_t i = 0; i < processors; i++) {
+        words += 2 + listCount(processorPending(listGet(hProcessors, i)));
+    }
+
+    unsigned int * record = (unsigned int *)malloc(words * sizeof(unsigned int));
+    if (!record) {
+        free(refs);
+        return 0;
+    }
+
+    record[SNAP_H_MAGIC] = SNAP_MAGIC;
+    record[SNAP_H_VERSION] = SNAP_VERSION;
+    record[SNAP_H_WORDS] = (unsigned int)words;
+    snapshotSplit(&record[SNAP_H_TIME_LO], time);
+    snapshotSplit(&record[SNAP_H_EMITTED_LO], emitted);
+    record[SNAP_H_PROCESSORS] = (unsigned int)processors;
+    record[SNAP_H_PROCS] = (unsigned int)listCount(hProcs);
+    record[SNAP_H_SUBPROCS] = (unsigned int)subCount;
+    record[SNAP_H_UNFINISHED] = unfinished;
+    record[SNAP_H_FINISHED] = finished;
+
+    // progress of each sub process
+    size_t w = SNAP_HEADER;
+    size_t count = listCount(hProcs);
+    for (size_t i = 0; i < count; i++) {
+        void * hSubProcs = procSubsHandle(listGet(hProcs, i));
+        size_t subs = listCount(hSubProcs);
+        for (size_t j = 0; j < subs; j++) {
+            void * hSubProc = listGet(hSubProcs, j);
+            snapshotSplit(&record[w], subProcWorked(hSubProc));
+            snapshotSplit(&record[w + 2], subProcCompletion(hSubProc));
+            w += SNAP_SUB;
+        }
+    }
+
+    // current sub process and pending queue of each processor
+    for (size_t i = 0; i < processors; i++) {
+        void * processor = listGet(hProcessors, i);
+        void * pending = processorPending(processor);
+        void * hCurrentSubProc = processorCurrentSubProc(processor);
+
+        record[w++] = hCurrentSubProc ? snapshotRefIndex(refs, subCount, hCurrentSubProc) : SNAP_NONE;
+
+        size_t pendingCount = listCount(pending);
+        record[w++] = (unsigned int)pendingCount;
+        for (size_t j = 0; j < pendingCount; j++) {
+            record[w++] = snapshotRefIndex(refs, subCount, listGet(pending, j));
+        }
+    }
+
+    record[w] = snapshotChecksum(record, words - 1);
+    free(refs);
+
+    FILE * hFile = fopen(fileName, "ab");
+    if (!hFile) {
+        free(record);
+        return 0;
+    }
+
+    size_t written = fwrite(record, sizeof(unsigned int), words, hFile);
+    int closed = fclose(hFile);
+    free(record);
+
+    return written == words && closed == 0;
+}
+
+// Restores the latest snapshot of the file taken at or before maxTime
+int snapshotLoad(const char * fileName, unsigned long long maxTime, unsigned long long * pTime,
+                 unsigned long long * pEmitted, unsigned int * pUnfinished, unsigned int * pFinished,
+                 void * hProcs, void * hProcessors) {
+    FILE * hFile = fopen(fileName, "rb");
+    if (!hFile) {
+        return 0;
+    }
+
+    unsigned int * latest = NULL; // latest usable record
+    unsigned int header[SNAP_HEADER];
+
+    // scan the records, keeping the latest complete one before maxTime
+    while (fread(header, sizeof(unsigned int), SNAP_HEADER, hFile) == SNAP_HEADER) {
+        if (header[SNAP_H_MAGIC] != SNAP_MAGIC || header[SNAP_H_VERSION] != SNAP_VERSION ||
+            header[SNAP_H_WORDS] <= SNAP_HEADER) {
+            break; // not a snapshot record
+        }
+
+        unsigned int * record = (unsigned int *)malloc(header[SNAP_H_WORDS] * sizeof(unsigned int));
+        if (!record) {
+            break;
+        }
+
+        memcpy(record, header, sizeof(header));
+        size_t rest = header[SNAP_H_WORDS] - SNAP_HEADER;
+        if (fread(record + SNAP_HEADER, sizeof(unsigned int), rest, hFile) != rest ||
+            record[header[SNAP_H_WORDS] - 1] != snapshotChecksum(record, header[SNAP_H_WORDS] - 1)) {
+            free(record); // torn record at the end of the file
+            break;
+        }
+
+        if (snapshotJoin(&header[SNAP_H_TIME_LO]) <= maxTime) {
+            free(latest);
+            latest = record;
+        } else {
+            free(record);
+        }
+    }
+
+    fclose(hFile);
+
+    if (!latest) {
+        return 0;
+    }
+
+    size_t subCount = 0;
+    SUBPROCREF * refs = snapshotRefs(hProcs, &subCount);
+    size_t processors = listCount(hProcessors);
+    size_t count = listCount(hProcs);
+
+    // the snapshot must come from the same trace and processor count
+    if (!refs || latest[SNAP_H_PROCESSORS] != processors || latest[SNAP_H_PROCS] != count ||
+        latest[SNAP_H_SUBPROCS] != subCount) {
+        free(refs);
+        free(latest);
+        return 0;
+    }
+
+    // the references are looked up by position, so the table is rebuilt in trace order
+    void ** hSubProcs = (void **)malloc((subCount + 1) * sizeof(void *));
+    if (!hSubProcs) {
+        free(refs);
+        free(latest);
+        return 0;
+    }
+
+    for (size_t i = 0; i < subCount; i++) {
+        hSubProcs[refs[i].index] = refs[i].hSubProc;
+    }
+    free(refs);
+
+    // check the processor section before touching any state, so a failed load leaves it untouched
+    size_t words = latest[SNAP_H_WORDS] - 1;
+    size_t w = SNAP_HEADER + SNAP_SUB * subCount;
+    int valid = 1;
+    for (size_t i = 0; i < processors && valid; i++) {
+        if (w + 2 > words || (latest[w] != SNAP_NONE && latest[w] >= subCount)) {
+            valid = 0;
+            break;
+        }
+
+        size_t pendingCount = latest[w + 1];
+        w += 2;
+        for (size_t j = 0; j < pendingCount && valid; j++, w++) {
+            valid = w < words && latest[w] < subCount;
+        }
+    }
+
+    if (valid) {
+        w = SNAP_HEADER;
+        for (size_t i = 0; i < subCount; i++) {
+            subProcRestore(hSubProcs[i], snapshotJoin(&latest[w]), snapshotJoin(&latest[w + 2]));
+            w += SNAP_SUB;
+        }
+
+        for (size_t i = 0; i < processors; i++) {
+            void * processor = listGet(hProcessors, i);
+            unsigned int current = latest[w++];
+            size_t pendingCount = latest[w++];
+
+            processorSetCurrent(processor, current == SNAP_NONE ? NULL : hSubProcs[current]);
+            for (size_t j = 0; j < pendingCount; j++) {
+                processorEnqueue(processor, j, hSubProcs[latest[w++]]);
+            }
+        }
+
+        *pTime = snapshotJoin(&latest[SNAP_H_TIME_LO]);
+        *pEmitted = snapshotJoin(&latest[SNAP_H_EMITTED_LO]);
+        *pUnfinished = latest[SNAP_H_UNFINISHED];
+        *pFinished = latest[SNAP_H_FINISHED];
+    }
+
+    free(hSubProcs);
+    free(latest);
+
+    return valid;
+}
+
+// helper function definitions
+
+// Computes the checksum of a record (FNV-1a)
+static unsigned int snapshotChecksum(const unsigned int * words, size_t count) {
+    unsigned int hash = 2166136261u;
+    const unsigned char * bytes = (const unsigned char *)words;
+
+    for (size_t i = 0; i < count * sizeof(unsigned int); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+// Builds the table of sub process references sorted by handle
+static SUBPROCREF * snapshotRefs(void * hProcs, size_t * pCount) {
+    size_t count = listCount(hProcs), subCount = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        subCount += procSubs(listGet(hProcs, i));
+    }
+
+    SUBPROCREF * refs = (SUBPROCREF *)malloc((subCount + 1) * sizeof(SUBPROCREF));
+    if (!refs) {
+        return NULL;
+    }
+
+    size_t r = 0;
+    for (size_t i = 0; i < count; i++) {
+        void * hSubProcs = procSubsHandle(listGet(hProcs, i));
+        size_t subs = listCount(hSubProcs);
+        for (size_t j = 0; j < subs; j++) {
+            refs[r].hSubProc = listGet(hSubProcs, j);
+            refs[r].index = (unsigned int)r;
+            r++;
+        }
+    }
+
+    qsort(refs, subCount, sizeof(SUBPROCREF), snapshotRefCompare);
+
+    *pCount = subCount;
+    return refs;
+}
+
+// Compares two sub process references by handle
+static int snapshotRefCompare(const void * a, const void * b) {
+    const SUBPROCREF * refA = (const SUBPROCREF *)a;
+    const SUBPROCREF * refB = (const SUBPROCREF *)b;
+
+    if (refA->hSubProc < refB->hSubProc) {
+        return -1;
+    }
+    return refA->hSubProc > refB->hSubProc;
+}
+
+// Finds the position of a sub process in the trace order
+static unsigned int snapshotRefIndex(SUBPROCREF * refs, size_t count, void * hSubProc) {
+    SUBPROCREF key = { hSubProc, 0 };
+    SUBPROCREF * found = (SUBPROCREF *)bsearch(&key, refs, count, sizeof(SUBPROCREF), snapshotRefCompare);
+
+    return found ? found->index : SNAP_NONE;
+}
+
+// Stores a 64 bit value in two words
+static void snapshotSplit(unsigned int * words, unsigned long long value) {
+    words[0] = (unsigned int)(value & 0xffffffffu);
+    words[1] = (unsigned int)(value >> 32);
+}
+
+// Reads a 64 bit value stored in two words
+static unsigned long long snapshotJoin(const unsigned int * words) {
+    return (unsigned long long)words[0] | ((unsigned long long)words[1] << 32);
+}
@@ -0,0 +1,30 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+// Include dependencies
+#include <stdio.h>
+#include <stdlib.h>
+#include "process.h"
+
+// Defines the checkpointing of a running simulation.
+// A snapshot file is a sequence of records appended one after another, each holding
+// the full simulator state at the end of a tick. A record that was cut short
+// (e.g. the simulator was killed while writing it) fails its checksum and is ignored.
+
+// Appends a snapshot of the simulator state at the end of the given tick
+// emitted is the number of output bytes written up to and including the tick
+// Returns 1 on success
+// Returns 0 if failed
+int snapshotSave(const char * fileName, unsigned long long time, unsigned long long emitted,
+                 unsigned int unfinished, unsigned int finished,
+                 void * hProcs, void * hProcessors);
+
+// Restores the latest snapshot of the file taken at or before maxTime
+// The processes and processors must be freshly created from the same trace and processor count
+// Returns 1 on success
+// Returns 0 if no usable snapshot is found, leaving the processes and processors untouched
+int snapshotLoad(const char * fileName, unsigned long long maxTime, unsigned long long * pTime,
+                 unsigned long long * pEmitted, unsigned int * pUnfinished, unsigned int * pFinished,
+                 void * hProcs, void * hProcessors);
+
+#endif
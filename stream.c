@@ -0,0 +1,304 @@
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include "stream.h"
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+// Define struct for a stream
+typedef struct {
+    STREAMFORMAT format;
+    FILE * hSource; // file of the trace
+    FILE * hFile; // file the lines are read from: the source, or the read end of the pipe
+    int output; // write end of the pipe
+    unsigned char * input; // buffers of the decompressor
+    unsigned char * inflated;
+    pthread_t thread;
+    int started;
+    int intact; // the decompressor reached the end of the compressed data
+} STREAM;
+
+// Helper functions declaration
+
+// Decompresses the source into the pipe (thread entry)
+static void * streamInflate(void * hStream);
+
+#if defined(USE_ZLIB) || defined(USE_ZSTD)
+// Writes inflated bytes to the pipe
+// Returns 1 on success
+// Returns 0 if the reader closed the pipe or failed
+static int streamWrite(STREAM * stream, const unsigned char * bytes, size_t length);
+#endif
+
+#ifdef USE_ZLIB
+// Decompresses gzip members until the end of the source
+// Returns 1 if the last member is complete
+// Returns 0 otherwise
+static int streamGzip(STREAM * stream);
+#endif
+
+#ifdef USE_ZSTD
+// Decompresses zstd frames until the end of the source
+// Returns 1 if the last frame is complete
+// Returns 0 otherwise
+static int streamZstd(STREAM * stream);
+#endif
+
+#define STM(h) if (!h) { return 0; } STREAM * stream = (STREAM*)h;
+
+// Checks if the build can read a format
+int streamSupports(STREAMFORMAT format) {
+    switch (format) {
+    case STREAM_PLAIN:
+        return 1;
+#ifdef USE_ZLIB
+    case STREAM_GZIP:
+        return 1;
+#endif
+#ifdef USE_ZSTD
+    case STREAM_ZSTD:
+        return 1;
+#endif
+    default:
+        return 0;
+    }
+}
+
+// Opens a trace, starting its decompressor if it is compressed
+void * streamOpen(const char * fileName, STREAMFORMAT * pFormat) {
+    FILE * hSource = fopen(fileName, "rb");
+    if (!hSource) {
+        return NULL;
+    }
+
+    // the magic bytes of the format
+    unsigned char magic[4] = { 0, 0, 0, 0 };
+    size_t read = fread(magic, 1, sizeof(magic), hSource);
+    STREAMFORMAT format = STREAM_PLAIN;
+    if (read >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        format = STREAM_GZIP;
+    } else if (read == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+        format = STREAM_ZSTD;
+    }
+    if (pFormat) {
+        *pFormat = format;
+    }
+
+    STREAM * stream = (STREAM *)calloc(1, sizeof(STREAM));
+    if (!stream || !streamSupports(format) || fseek(hSource, 0, SEEK_SET) != 0) {
+        free(stream);
+        fclose(hSource);
+        return NULL;
+    }
+    stream->format = format;
+    stream->hSource = hSource;
+    stream->output = -1;
+
+    if (format == STREAM_PLAIN) {
+        stream->hFile = hSource;
+        return stream;
+    }
+
+    int pipeEnds[2];
+    stream->input = (unsigned char *)malloc(STREAM_BUFFER);
+    stream->inflated = (unsigned char *)malloc(STREAM_BUFFER);
+    if (!stream->input || !stream->inflated || pipe(pipeEnds) != 0) {
+        streamClose(stream);
+        return NULL;
+    }
+    stream->output = pipeEnds[1];
+    stream->hFile = fdopen(pipeEnds[0], "r");
+    if (!stream->hFile) {
+        close(pipeEnds[0]);
+        streamClose(stream);
+        return NULL;
+    }
+
+    stream->started = pthread_create(&stream->thread, NULL, streamInflate, stream) == 0;
+    if (!stream->started) {
+        streamClose(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+// Gets the file the lines of the trace are read from
+FILE * streamFile(void * hStream) {
+    STM(hStream)
+
+    return stream->hFile;
+}
+
+// Closes a trace, stopping its decompressor
+int streamClose(void * hStream) {
+    STM(hStream)
+
+    int intact = 1;
+    if (stream->format != STREAM_PLAIN) {
+        // closing the read end stops a decompressor that is still writing
+        if (stream->hFile) {
+            fclose(stream->hFile);
+        }
+        if (stream->started) {
+            pthread_join(stream->thread, NULL);
+        } else if (stream->output >= 0) {
+            close(stream->output);
+        }
+        intact = stream->started && stream->intact;
+    }
+
+    fclose(stream->hSource);
+    free(stream->input);
+    free(stream->inflated);
+    free(stream);
+
+    return intact;
+}
+
+// helper function definitions
+
+// Decompresses the source into the pipe
+static void * streamInflate(void * hStream) {
+    STREAM * stream = (STREAM *)hStream;
+
+    // a write to a closed pipe fails with EPIPE instead of ending the program
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+#ifdef USE_ZLIB
+    if (stream->format == STREAM_GZIP) {
+        stream->intact = streamGzip(stream);
+    }
+#endif
+#ifdef USE_ZSTD
+    if (stream->format == STREAM_ZSTD) {
+        stream->intact = streamZstd(stream);
+    }
+#endif
+
+    close(stream->output); // the reader sees the end of the trace
+    stream->output = -1;
+
+    return NULL;
+}
+
+#if defined(USE_ZLIB) || defined(USE_ZSTD)
+// Writes inflated bytes to the pipe
+static int streamWrite(STREAM * stream, const unsigned char * bytes, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(stream->output, bytes, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+        bytes += written;
+        length -= (size_t)written;
+    }
+
+    return 1;
+}
+#endif
+
+#ifdef USE_ZLIB
+// Decompresses gzip members until the end of the source
+static int streamGzip(STREAM * stream) {
+    z_stream inflater;
+    memset(&inflater, 0, sizeof(inflater));
+    if (inflateInit2(&inflater, 15 + 16) != Z_OK) { // gzip header
+        return 0;
+    }
+
+    int ended = 0; // the last member is complete
+    int full = 0; // the output buffer was filled, inflate may hold more
+    int failed = 0;
+    for (;;) {
+        if (inflater.avail_in == 0 && !full) {
+            size_t read = fread(stream->input, 1, STREAM_BUFFER, stream->hSource);
+            if (read == 0) {
+                break;
+            }
+            inflater.next_in = stream->input;
+            inflater.avail_in = (uInt)read;
+        }
+
+        inflater.next_out = stream->inflated;
+        inflater.avail_out = STREAM_BUFFER;
+        int status = inflate(&inflater, Z_NO_FLUSH);
+        size_t produced = STREAM_BUFFER - inflater.avail_out;
+
+        if (status == Z_STREAM_END) {
+            ended = 1;
+            inflateReset(&inflater); // a concatenated member may follow
+        } else if (status == Z_OK) {
+            ended = 0;
+        } else if (status != Z_BUF_ERROR || inflater.avail_in > 0) {
+            failed = 1; // corrupt data
+            break;
+        }
+        full = inflater.avail_out == 0;
+
+        if (!streamWrite(stream, stream->inflated, produced)) {
+            failed = 1;
+            break;
+        }
+    }
+
+    inflateEnd(&inflater);
+
+    return !failed && ended && !ferror(stream->hSource);
+}
+#endif
+
+#ifdef USE_ZSTD
+// Decompresses zstd frames until the end of the source
+static int streamZstd(STREAM * stream) {
+    ZSTD_DStream * inflater = ZSTD_createDStream();
+    if (!inflater || ZSTD_isError(ZSTD_initDStream(inflater))) {
+        ZSTD_freeDStream(inflater);
+        return 0;
+    }
+
+    ZSTD_inBuffer input = { stream->input, 0, 0 };
+    size_t hint = 1; // 0 once a frame is complete
+    int full = 0; // the output buffer was filled, the frame may hold more
+    int failed = 0;
+    for (;;) {
+        if (input.pos == input.size && !full) {
+            size_t read = fread(stream->input, 1, STREAM_BUFFER, stream->hSource);
+            if (read == 0) {
+                break;
+            }
+            input.size = read;
+            input.pos = 0;
+        }
+
+        ZSTD_outBuffer output = { stream->inflated, STREAM_BUFFER, 0 };
+        hint = ZSTD_decompressStream(inflater, &output, &input);
+        if (ZSTD_isError(hint)) {
+            failed = 1; // corrupt data
+            break;
+        }
+        full = output.pos == output.size;
+
+        if (!streamWrite(stream, stream->inflated, output.pos)) {
+            failed = 1;
+            break;
+        }
+    }
+
+    ZSTD_freeDStream(inflater);
+
+    return !failed && hint == 0 && !ferror(stream->hSource);
+}
+#endif
@@ -0,0 +1,42 @@
+#ifndef STREAM_H_
+#define STREAM_H_
+
+// Include dependencies
+#include <stdio.h>
+#include <stdlib.h>
+
+// Defines the input streams of the traces.
+// A compressed trace is recognised by its magic bytes and inflated on a thread of its own, which
+// writes the lines through a pipe read by the parser. The decompressor holds one buffer of input and
+// one of output, so a trace is never inflated whole, in memory or on disk.
+// gzip needs a build with make ZLIB=1, zstd a build with make ZSTD=1.
+
+#define STREAM_BUFFER (1 << 18) // bytes of each buffer of the decompressor
+
+// Formats of a trace
+typedef enum {
+    STREAM_PLAIN = 0,
+    STREAM_GZIP,
+    STREAM_ZSTD
+} STREAMFORMAT;
+
+// Checks if the build can read a format
+// Returns 1 if it can
+// Returns 0 otherwise
+int streamSupports(STREAMFORMAT format);
+
+// Opens a trace, starting its decompressor if it is compressed
+// Sets the format of the file when it could be read, even if it is not supported
+// Returns the pointer on success
+// Returns NULL if the file cannot be read, its format is not supported or failed
+void * streamOpen(const char * fileName, STREAMFORMAT * pFormat);
+
+// Gets the file the lines of the trace are read from
+FILE * streamFile(void * hStream);
+
+// Closes a trace, stopping its decompressor
+// Returns 1 if the whole trace was read back intact
+// Returns 0 if the compressed data is corrupt or cut short, or the stream was closed before its end
+int streamClose(void * hStream);
+
+#endif
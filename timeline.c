@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Expands the interval output of allocate (-o interval) back to the default output:
+// a RUNNING line at the start of each execution segment and a FINISHED line per process,
+// ordered by tick, the FINISHED lines of a tick first (in their original order), then the
+// RUNNING lines by cpu. The other lines (statistics) follow unchanged.
+// Usage: timeline [file], reads stdin without a file
+
+// Define struct for an event of the default output
+typedef struct {
+    unsigned long long time;
+    unsigned int running; // 0 for FINISHED, 1 for RUNNING, so FINISHED lines come first
+    unsigned int order; // cpu of a RUNNING line, position of a FINISHED line
+    unsigned long long value; // remaining time (RUNNING) or unfinished processes (FINISHED)
+    char pid[32];
+} RECORD;
+
+// Compares two records by tick, type and order
+static int recordCompare(const void * a, const void * b) {
+    const RECORD * recA = (const RECORD *)a;
+    const RECORD * recB = (const RECORD *)b;
+
+    if (recA->time != recB->time) {
+        return recA->time < recB->time ? -1 : 1;
+    }
+    if (recA->running != recB->running) {
+        return recA->running < recB->running ? -1 : 1;
+    }
+    if (recA->order != recB->order) {
+        return recA->order < recB->order ? -1 : 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    FILE * hFile = argc > 1 ? fopen(argv[1], "r") : stdin;
+
+    if (!hFile) {
+        fprintf(stderr, "Failed to open %s.\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    RECORD * records = NULL;
+    size_t count = 0, size = 0;
+    char * trailer = NULL; // lines that are not events
+    size_t trailerLength = 0;
+
+    char * sLine = NULL;
+    size_t lineSize = 0;
+    ssize_t length = 0;
+    int failed = 0;
+
+    while (!failed && (length = getline(&sLine, &lineSize, hFile)) != -1) {
+        RECORD record;
+        unsigned long long end = 0;
+        char sReason[16];
+        memset(&record, 0, sizeof(record));
+
+        if (sscanf(sLine, "F,%llu,%31[0-9],%llu", &record.time, record.pid, &record.value) == 3) {
+            record.running = 0;
+            record.order = (unsigned int)count;
+        } else if (sscanf(sLine, "S,%u,%31[0-9.],%llu,%llu,%llu,%15s", &record.order, record.pid, &record.time, &end,
+                          &record.value, sReason) == 6) {
+            record.running = 1;
+        } else {
+            char * grown = (char *)realloc(trailer, trailerLength + (size_t)length + 1);
+            if (!grown) {
+                failed = 1;
+                break;
+            }
+            trailer = grown;
+            memcpy(trailer + trailerLength, sLine, (size_t)length + 1);
+            trailerLength += (size_t)length;
+            continue;
+        }
+
+        if (count == size) {
+            size = size ? size * 2 : 1024;
+            RECORD * grown = (RECORD *)realloc(records, size * sizeof(RECORD));
+            if (!grown) {
+                failed = 1;
+                break;
+            }
+            records = grown;
+        }
+        records[count++] = record;
+    }
+
+    free(sLine);
+    if (hFile != stdin) {
+        fclose(hFile);
+    }
+
+    if (failed) {
+        fprintf(stderr, "Failed to allocate memory for the events.\n");
+        free(records);
+        free(trailer);
+        return EXIT_FAILURE;
+    }
+
+    qsort(records, count, sizeof(RECORD), recordCompare);
+
+    for (size_t i = 0; i < count; i++) {
+        if (records[i].running) {
+            printf("%llu,RUNNING,pid=%s,remaining_time=%llu,cpu=%u\n", records[i].time, records[i].pid, records[i].value, records[i].order);
+        } else {
+            printf("%llu,FINISHED,pid=%s,proc_remaining=%llu\n", records[i].time, records[i].pid, records[i].value);
+        }
+    }
+
+    if (trailer) {
+        fputs(trailer, stdout);
+    }
+
+    free(records);
+    free(trailer);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,556 @@
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <string.h>
+#include "trace.h"
+#include "process.h"
+#include "list.h"
+
+#define TRACE_NOTENANT ((size_t)-1)
+
+// Define struct for a parsed line, its columns are stored in the pools of its chunk
+typedef struct {
+    unsigned int pid;
+    unsigned int parallel;
+    size_t tenant; // offset of the tenant name, TRACE_NOTENANT if none
+    unsigned long weight;
+    int hasWeight;
+    size_t afterFirst; // position of the first after= pid
+    unsigned int afterCount;
+    unsigned int phaseCount;
+    int badBursts;
+    void * hProc;
+} TRACEREC;
+
+// Define struct for a chunk of parsed lines
+typedef struct {
+    TRACEREC * lines;
+    size_t count;
+    size_t size;
+    unsigned int * after; // after= pids of the lines
+    size_t afterCount;
+    size_t afterSize;
+    unsigned long long * phases; // bursts of the line being parsed
+    unsigned int phaseSize;
+    char * names; // tenant names of the lines
+    size_t namesLength;
+    size_t namesSize;
+    unsigned int processors;
+    int failed;
+} TRACECHUNK;
+
+// Define struct for a worker, parsing a block into a chunk
+typedef struct {
+    char * data; // block of whole lines
+    size_t length;
+    size_t capacity;
+    TRACECHUNK chunk;
+    pthread_t thread;
+    int started;
+} TRACEWORKER;
+
+// Define struct for a reader
+typedef struct {
+    FILE * hFile;
+    char * carry; // partial line at the end of the last block
+    size_t carryLength;
+    size_t carrySize;
+    int eof;
+    int failed;
+} TRACEREADER;
+
+// Helper functions declaration
+
+// Fills the block of a worker with whole lines, starting with the carried partial line
+// Returns 1 if the block has data
+// Returns 0 at the end of the input or if failed
+static int traceFill(TRACEREADER * reader, TRACEWORKER * worker);
+
+// Parses the lines of a worker's block into its chunk (thread entry)
+static void * traceParseBlock(void * hWorker);
+
+// Parses a line into a chunk and creates its process
+// Returns 1 on success (blank and malformed lines are skipped)
+// Returns 0 if failed
+static int traceParse(TRACECHUNK * chunk, char * sLine);
+
+// Empties a chunk, deleting the processes that were not taken
+static void traceClear(TRACECHUNK * chunk);
+
+// Grows an array to hold one more item
+// Returns 1 on success
+// Returns 0 if failed
+static int traceGrow(void ** pArray, size_t * pSize, size_t count, size_t itemSize, size_t initial);
+
+// Reads a decimal number of at most max from the start of a column
+// Stops at the end of the column if psEnd is NULL, at the first non digit otherwise
+// Returns 1 on success
+// Returns 0 if it is not a number or out of range
+static int traceNumber(const char * sText, unsigned long long max, unsigned long long * pValue, const char ** psEnd);
+
+// Checks a list column (after=, phases=): numbers of at most max separated by commas
+// Returns 1 if it is well formed
+// Returns 0 otherwise
+static int traceList(const char * sList, unsigned long long max);
+
+#define TRC(h) if (!h) { return 0; } TRACECHUNK * chunk = (TRACECHUNK*)h;
+#define TRCN(h) if (!h) { return; } TRACECHUNK * chunk = (TRACECHUNK*)h;
+
+// Reads a trace, calling consume for each chunk of parsed lines in file order
+int traceRead(FILE * hFile, unsigned int threads, unsigned int processors, int (*consume)(void * context, void * hChunk), void * context) {
+    if (!hFile || !consume || threads == 0) {
+        return 0;
+    }
+
+    // two sets of workers: the blocks of one set are read while the other set is parsed
+    TRACEWORKER * workers = (TRACEWORKER *)calloc(2 * (size_t)threads, sizeof(TRACEWORKER));
+    if (!workers) {
+        return 0;
+    }
+    for (unsigned int i = 0; i < 2 * threads; i++) {
+        workers[i].chunk.processors = processors;
+    }
+
+    TRACEREADER reader;
+    memset(&reader, 0, sizeof(reader));
+    reader.hFile = hFile;
+
+    TRACEWORKER * current = workers, * next = workers + threads;
+    unsigned int filled = 0;
+    while (filled < threads && traceFill(&reader, &current[filled])) {
+        filled++;
+    }
+
+    int consumed = 1;
+    while (filled > 0 && consumed && !reader.failed) {
+        // a single worker parses on the calling thread, as does a worker whose thread cannot start
+        for (unsigned int i = 0; i < filled && threads > 1; i++) {
+            current[i].started = pthread_create(&current[i].thread, NULL, traceParseBlock, &current[i]) == 0;
+        }
+
+        unsigned int nextFilled = 0;
+        if (threads > 1) {
+            while (nextFilled < threads && traceFill(&reader, &next[nextFilled])) {
+                nextFilled++;
+            }
+        }
+
+        for (unsigned int i = 0; i < filled; i++) {
+            if (current[i].started) {
+                pthread_join(current[i].thread, NULL);
+                current[i].started = 0;
+            } else {
+                traceParseBlock(&current[i]);
+            }
+        }
+
+        // hand the chunks over in file order
+        for (unsigned int i = 0; i < filled; i++) {
+            if (consumed && (current[i].chunk.failed || !consume(context, &current[i].chunk))) {
+                consumed = 0;
+            }
+            traceClear(&current[i].chunk);
+        }
+
+        if (threads == 1) {
+            nextFilled = traceFill(&reader, &next[0]);
+        }
+
+        TRACEWORKER * swap = current;
+        current = next;
+        next = swap;
+        filled = nextFilled;
+    }
+
+    for (unsigned int i = 0; i < 2 * threads; i++) {
+        traceClear(&workers[i].chunk);
+        free(workers[i].chunk.lines);
+        free(workers[i].chunk.after);
+        free(workers[i].chunk.phases);
+        free(workers[i].chunk.names);
+        free(workers[i].data);
+    }
+    free(workers);
+    free(reader.carry);
+
+    return consumed && !reader.failed;
+}
+
+// Gets the number of lines of a chunk
+size_t traceCount(void * hChunk) {
+    TRC(hChunk)
+
+    return chunk->count;
+}
+
+// Gets a line of a chunk
+void traceLine(void * hChunk, size_t index, TRACELINE * line) {
+    TRCN(hChunk)
+
+    const TRACEREC * rec = &chunk->lines[index];
+    line->pid = rec->pid;
+    line->parallel = rec->parallel;
+    line->tenant = rec->tenant == TRACE_NOTENANT ? NULL : chunk->names + rec->tenant;
+    line->weight = rec->weight;
+    line->hasWeight = rec->hasWeight;
+    line->after = chunk->after + rec->afterFirst;
+    line->afterCount = rec->afterCount;
+    line->phaseCount = rec->phaseCount;
+    line->badBursts = rec->badBursts;
+    line->hProc = rec->hProc;
+}
+
+// Takes the process of a line from its chunk
+void * traceTake(void * hChunk, size_t index) {
+    TRC(hChunk)
+
+    void * hProc = chunk->lines[index].hProc;
+    chunk->lines[index].hProc = NULL;
+
+    return hProc;
+}
+
+// Splits a line of a trace into its columns
+// Each line holds the arrival time, pid, execution time and p (parallelisable) or n,
+// optionally followed by key=value columns (see loadProcesses); the last column of a key wins
+// Numbers are plain decimal digits: a sign or a value out of range makes the line malformed, rather
+// than wrapping around or saturating
+int traceSplit(char * sLine, TRACEFIELDS * fields) {
+    char * sColumns[4];
+    char * sSave = NULL;
+    unsigned long long value = 0;
+
+    memset(fields, 0, sizeof(TRACEFIELDS));
+    int count = 0;
+    while (count < 4 && (sColumns[count] = strtok_r(count == 0 ? sLine : NULL, " \t\r\n", &sSave)) != NULL) {
+        count++;
+    }
+    if (count == 0) {
+        return 0; // blank
+    }
+
+    // the pid first, so the other errors can name the process
+    if (count > 1 && traceNumber(sColumns[1], UINT_MAX, &value, NULL)) {
+        fields->pid = (unsigned int)value;
+        fields->hasPid = 1;
+    }
+    if (count < 4) {
+        fields->error = "has fewer than four columns";
+    } else if (!fields->hasPid) {
+        fields->error = "has an invalid pid";
+    } else if (!traceNumber(sColumns[0], ~0ULL, &fields->arrival, NULL)) {
+        fields->error = "has an invalid arrival time";
+    } else if (!traceNumber(sColumns[2], ~0ULL, &fields->execution, NULL)) {
+        fields->error = "has an invalid execution time";
+    }
+    if (fields->error) {
+        return 0;
+    }
+    fields->parallel = strcmp(sColumns[3], "p") == 0;
+
+    for (char * sColumn = strtok_r(NULL, " \t\r\n", &sSave); sColumn && !fields->error;
+         sColumn = strtok_r(NULL, " \t\r\n", &sSave)) {
+        if (strncmp(sColumn, "after=", 6) == 0) {
+            fields->after = sColumn + 6;
+            if (!traceList(fields->after, UINT_MAX)) {
+                fields->error = "has an invalid after= column";
+            }
+        } else if (strncmp(sColumn, "tenant=", 7) == 0) {
+            fields->tenant = sColumn + 7;
+        } else if (strncmp(sColumn, "weight=", 7) == 0) {
+            // the weights of the tenants are unsigned int
+            fields->hasWeight = 1;
+            if (traceNumber(sColumn + 7, UINT_MAX, &value, NULL)) {
+                fields->weight = (unsigned long)value;
+            } else {
+                fields->error = "has an invalid weight= column";
+            }
+        } else if (strncmp(sColumn, "mem=", 4) == 0) {
+            if (!traceNumber(sColumn + 4, ~0ULL, &fields->memory, NULL)) {
+                fields->error = "has an invalid mem= column";
+            }
+        } else if (strncmp(sColumn, "phases=", 7) == 0) {
+            fields->phases = sColumn + 7;
+            if (!traceList(fields->phases, ~0ULL)) {
+                fields->error = "has an invalid phases= column";
+            }
+        }
+        // skip undefined columns
+    }
+    if (fields->error) {
+        return 0;
+    }
+
+    return 1;
+}
+
+// Reads the next number of a list column and moves past it and its comma
+// The list was checked by traceSplit
+int traceNext(const char ** psList, unsigned long long * pValue) {
+    const char * sEnd = NULL;
+    if (!traceNumber(*psList, ~0ULL, pValue, &sEnd)) {
+        return 0;
+    }
+
+    *psList = *sEnd == ',' ? sEnd + 1 : sEnd;
+
+    return 1;
+}
+
+// helper function definitions
+
+// Fills the block of a worker with whole lines
+static int traceFill(TRACEREADER * reader, TRACEWORKER * worker) {
+    if (reader->failed || (reader->eof && reader->carryLength == 0)) {
+        return 0;
+    }
+
+    size_t capacity = reader->carryLength + TRACE_BLOCK + 1;
+    if (worker->capacity < capacity) {
+        char * grown = (char *)realloc(worker->data, capacity);
+        if (!grown) {
+            reader->failed = 1;
+            return 0;
+        }
+        worker->data = grown;
+        worker->capacity = capacity;
+    }
+
+    if (reader->carryLength > 0) {
+        memcpy(worker->data, reader->carry, reader->carryLength);
+    }
+    size_t length = reader->carryLength;
+    size_t scanned = length; // bytes known to hold no newline
+    reader->carryLength = 0;
+
+    char * newline = NULL;
+    while (!reader->eof) {
+        size_t read = fread(worker->data + length, 1, worker->capacity - 1 - length, reader->hFile);
+        if (read == 0) {
+            if (ferror(reader->hFile)) {
+                reader->failed = 1;
+                return 0;
+            }
+            reader->eof = 1;
+            break;
+        }
+        length += read;
+
+        // the block ends after its last newline
+        for (char * p = worker->data + length; p > worker->data + scanned; p--) {
+            if (p[-1] == '\n') {
+                newline = p - 1;
+                break;
+            }
+        }
+        if (newline) {
+            break;
+        }
+        scanned = length;
+
+        if (length + 1 == worker->capacity) {
+            // the line is longer than the block
+            char * grown = (char *)realloc(worker->data, worker->capacity * 2);
+            if (!grown) {
+                reader->failed = 1;
+                return 0;
+            }
+            worker->data = grown;
+            worker->capacity *= 2;
+        }
+    }
+
+    // carry the partial line to the next block
+    if (newline) {
+        size_t cut = (size_t)(newline - worker->data) + 1;
+        size_t rest = length - cut;
+        if (rest + 1 > reader->carrySize) {
+            char * grown = (char *)realloc(reader->carry, rest + 1 > TRACE_BLOCK ? rest + 1 : TRACE_BLOCK);
+            if (!grown) {
+                reader->failed = 1;
+                return 0;
+            }
+            reader->carry = grown;
+            reader->carrySize = rest + 1 > TRACE_BLOCK ? rest + 1 : TRACE_BLOCK;
+        }
+        memcpy(reader->carry, worker->data + cut, rest);
+        reader->carryLength = rest;
+        length = cut;
+    }
+
+    worker->data[length] = '\0';
+    worker->length = length;
+
+    return length > 0;
+}
+
+// Parses the lines of a worker's block into its chunk
+static void * traceParseBlock(void * hWorker) {
+    TRACEWORKER * worker = (TRACEWORKER *)hWorker;
+    char * sLine = worker->data;
+    char * sEnd = worker->data + worker->length;
+
+    while (sLine < sEnd && !worker->chunk.failed) {
+        char * newline = (char *)memchr(sLine, '\n', (size_t)(sEnd - sLine));
+        char * sNext = newline ? newline + 1 : sEnd;
+        if (newline) {
+            *newline = '\0';
+        }
+
+        if (!traceParse(&worker->chunk, sLine)) {
+            worker->chunk.failed = 1;
+        }
+        sLine = sNext;
+    }
+
+    return NULL;
+}
+
+// Parses a line into a chunk and creates its process
+static int traceParse(TRACECHUNK * chunk, char * sLine) {
+    TRACEFIELDS fields;
+    if (!traceSplit(sLine, &fields)) {
+        return 1; // skip blank or malformed lines
+    }
+
+    if (!traceGrow((void **)&chunk->lines, &chunk->size, chunk->count, sizeof(TRACEREC), 1024)) {
+        return 0;
+    }
+    TRACEREC * rec = &chunk->lines[chunk->count];
+    memset(rec, 0, sizeof(TRACEREC));
+    rec->pid = fields.pid;
+    rec->tenant = TRACE_NOTENANT;
+    rec->afterFirst = chunk->afterCount;
+    rec->weight = fields.weight;
+    rec->hasWeight = fields.hasWeight;
+
+    const char * sList = fields.after;
+    unsigned long long value = 0;
+    while (sList && traceNext(&sList, &value)) {
+        if (!traceGrow((void **)&chunk->after, &chunk->afterSize, chunk->afterCount, sizeof(unsigned int), 64)) {
+            return 0;
+        }
+        chunk->after[chunk->afterCount++] = (unsigned int)value;
+        rec->afterCount++;
+    }
+
+    if (fields.tenant) {
+        size_t length = strlen(fields.tenant) + 1;
+        while (chunk->namesLength + length > chunk->namesSize) {
+            if (!traceGrow((void **)&chunk->names, &chunk->namesSize, chunk->namesSize, 1, 256)) {
+                return 0;
+            }
+        }
+        memcpy(chunk->names + chunk->namesLength, fields.tenant, length);
+        rec->tenant = chunk->namesLength;
+        chunk->namesLength += length;
+    }
+
+    sList = fields.phases;
+    while (sList && traceNext(&sList, &value)) {
+        size_t phaseSize = chunk->phaseSize;
+        if (!traceGrow((void **)&chunk->phases, &phaseSize, rec->phaseCount, sizeof(unsigned long long), 16)) {
+            return 0;
+        }
+        chunk->phaseSize = (unsigned int)phaseSize;
+        chunk->phases[rec->phaseCount++] = value;
+    }
+
+    unsigned long long exec = fields.execution;
+    rec->parallel = fields.parallel;
+    if (rec->phaseCount > 0) {
+        rec->parallel = 0; // the bursts of a process run in sequence
+        exec = 0;
+        for (unsigned int i = 0; i < rec->phaseCount; i += 2) {
+            exec = chunk->phases[i] > ~0ULL - exec ? ~0ULL : exec + chunk->phases[i]; // saturates
+        }
+    }
+
+    rec->hProc = procCreate(fields.arrival, fields.pid, exec, rec->parallel, chunk->processors);
+    if (!rec->hProc) {
+        return 0;
+    }
+    chunk->count++;
+
+    procSetMemory(rec->hProc, fields.memory);
+
+    if (fields.phases && (rec->phaseCount == 0 || !subProcSetPhases(listGet(procSubsHandle(rec->hProc), 0), chunk->phases, rec->phaseCount))) {
+        rec->badBursts = 1;
+    }
+
+    return 1;
+}
+
+// Empties a chunk, deleting the processes that were not taken
+static void traceClear(TRACECHUNK * chunk) {
+    for (size_t i = 0; i < chunk->count; i++) {
+        if (chunk->lines[i].hProc) {
+            procDelete(chunk->lines[i].hProc);
+        }
+    }
+    chunk->count = 0;
+    chunk->afterCount = 0;
+    chunk->namesLength = 0;
+    chunk->failed = 0;
+}
+
+// Grows an array to hold one more item
+static int traceGrow(void ** pArray, size_t * pSize, size_t count, size_t itemSize, size_t initial) {
+    if (count < *pSize) {
+        return 1;
+    }
+
+    size_t size = *pSize ? *pSize * 2 : initial;
+    void * grown = realloc(*pArray, size * itemSize);
+    if (!grown) {
+        return 0;
+    }
+    *pArray = grown;
+    *pSize = size;
+
+    return 1;
+}
+
+// Reads a decimal number of at most max from the start of a column
+// strtoull takes a sign and leading spaces, and negates a minus, so the column must start with a digit
+static int traceNumber(const char * sText, unsigned long long max, unsigned long long * pValue, const char ** psEnd) {
+    if (*sText < '0' || *sText > '9') {
+        return 0;
+    }
+
+    char * sEnd = NULL;
+    errno = 0;
+    unsigned long long value = strtoull(sText, &sEnd, 10);
+    if (errno == ERANGE || value > max || (!psEnd && *sEnd != '\0')) {
+        return 0;
+    }
+
+    *pValue = value;
+    if (psEnd) {
+        *psEnd = sEnd;
+    }
+
+    return 1;
+}
+
+// Checks a list column (after=, phases=): numbers of at most max separated by commas
+static int traceList(const char * sList, unsigned long long max) {
+    if (*sList == '\0') {
+        return 1; // no items
+    }
+
+    for (;;) {
+        unsigned long long value = 0;
+        const char * sEnd = NULL;
+        if (!traceNumber(sList, max, &value, &sEnd)) {
+            return 0;
+        }
+        if (*sEnd == '\0') {
+            return 1;
+        }
+        if (*sEnd != ',') {
+            return 0;
+        }
+        sList = sEnd + 1;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+// Include dependencies
+#include <stdio.h>
+#include <stdlib.h>
+
+// Defines the reader of the text traces.
+// The input is cut into blocks at newline boundaries; worker threads parse the blocks into chunks of
+// lines, creating the process of each line, and the chunks are handed over in file order, so the
+// processes come out in the same order whatever the number of threads.
+
+#define TRACE_BLOCK (1 << 20) // bytes read for each worker, a longer line grows its block
+
+// Line of a trace
+typedef struct {
+    unsigned int pid;
+    unsigned int parallel; // the process has sub processes (p column and no phases)
+    const char * tenant; // tenant= column, NULL if none
+    unsigned long weight; // weight= column
+    int hasWeight;
+    const unsigned int * after; // pids of the after= column
+    unsigned int afterCount;
+    unsigned int phaseCount; // number of bursts of the phases= column
+    int badBursts; // the phases= column is empty, has an empty burst or ends with an I/O burst
+    void * hProc; // process of the line
+} TRACELINE;
+
+// Columns of a line of a trace, the text ones point into the line
+typedef struct {
+    unsigned long long arrival;
+    unsigned int pid;
+    unsigned long long execution;
+    unsigned int parallel; // p column
+    unsigned long long memory; // mem= column, 0 if none
+    const char * tenant; // tenant= column, NULL if none
+    unsigned long weight; // weight= column
+    int hasWeight;
+    const char * after; // after= column, pids separated by commas (traceNext), NULL if none
+    const char * phases; // phases= column, bursts separated by commas (traceNext), NULL if none
+    int hasPid; // the pid column is valid, even if the line is malformed
+    const char * error; // why the line is malformed, NULL if it is a process or blank
+} TRACEFIELDS;
+
+// Reads a trace, calling consume for each chunk of parsed lines in file order
+// The processes of a chunk belong to it until they are taken (traceTake)
+// Returns 1 on success
+// Returns 0 if reading or parsing failed, or consume returned 0
+int traceRead(FILE * hFile, unsigned int threads, unsigned int processors, int (*consume)(void * context, void * hChunk), void * context);
+
+// Gets the number of lines of a chunk
+size_t traceCount(void * hChunk);
+
+// Gets a line of a chunk, valid until consume returns
+void traceLine(void * hChunk, size_t index, TRACELINE * line);
+
+// Takes the process of a line from its chunk
+// Returns the process
+// Returns NULL if it was taken
+void * traceTake(void * hChunk, size_t index);
+
+// Splits a line of a trace into its columns, cutting the line at the end of each key=value column
+// (the trace loader and the service read their lines with it)
+// Returns 1 if the line is a process
+// Returns 0 if the line is blank or malformed (fields->error is set)
+int traceSplit(char * sLine, TRACEFIELDS * fields);
+
+// Reads the next number of a list column (after=, phases=) and moves past it
+// Returns 1 if there was a number
+// Returns 0 at the end of the list
+int traceNext(const char ** psList, unsigned long long * pValue);
+
+#endif